@@ -0,0 +1,187 @@
+#include <filesystem>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_test_macros.hpp>
+
+#include <frontend/ast/ast_cache.hpp>
+#include <frontend/ast/flat_tree.hpp>
+#include <frontend/lexer.hpp>
+#include <frontend/parser.hpp>
+#include <frontend/token_stream.hpp>
+#include <passes/pass.hpp>
+#include <passes/static_pass.hpp>
+#include <utils/arena.hpp>
+
+// sums the integer literals by walking the whole pointer tree
+struct SumLiterals : W::Passes::VisitorPass {
+    void walk(W::Ast::Node* node) {
+        if (node != nullptr)
+            node->visit(*this);
+    }
+
+    void visit(W::Ast::AccessIdentifierExpression& expr) override { for (auto member : expr.members) walk(member); }
+    void visit(W::Ast::CallExpression& expr) override { walk(expr.callee); for (auto param : expr.params) walk(param); }
+    void visit(W::Ast::BinaryExpression& expr) override { walk(expr.left); walk(expr.right); }
+    void visit(W::Ast::UnaryExpression& expr) override { walk(expr.expr); }
+    void visit(W::Ast::IdentExpression&) override {}
+    void visit(W::Ast::ParentExpression& expr) override { walk(expr.expr); }
+    void visit(W::Ast::ArrayTypeExpression& expr) override { walk(expr.lenght); walk(expr.inner_type); }
+    void visit(W::Ast::SliceTypeExpression& expr) override { walk(expr.inner_type); }
+    void visit(W::Ast::BoolLiteral&) override {}
+    void visit(W::Ast::IntLiteral& lit) override { sum += lit.value; }
+    void visit(W::Ast::FloatLiteral&) override {}
+    void visit(W::Ast::EnumVariantLiteral&) override {}
+    void visit(W::Ast::RuneLiteral&) override {}
+    void visit(W::Ast::StringLiteral&) override {}
+    void visit(W::Ast::ExpressionStatement& stmt) override { walk(stmt.expr); }
+    void visit(W::Ast::DeclareFunctionStatement& stmt) override { for (auto body : stmt.body) walk(body); }
+    void visit(W::Ast::DeclareVariableStatement& stmt) override { walk(stmt.value); }
+
+    int64_t sum = 0;
+};
+
+// counts every node, through Node::visit and the handle_children helpers
+struct CountNodesVirtual : W::Passes::VisitorPass {
+    #define WLANG_AST(X, C) void visit(W::Ast::X##C& node) override { count++; handle_children(node); }
+    #include <frontend/ast/node_list.hpp>
+
+    std::size_t count = 0;
+};
+
+// same count with a switch on the kind and the default traversal
+struct CountNodesStatic : W::Passes::StaticPass<CountNodesStatic> {
+    #define WLANG_AST(X, C) void visit(W::Ast::X##C& node) { count++; traverse(node); }
+    #include <frontend/ast/node_list.hpp>
+
+    std::size_t count = 0;
+};
+
+// a pass interested in a single kind
+struct SumLiteralsStatic : W::Passes::StaticPass<SumLiteralsStatic> {
+    void visit(W::Ast::IntLiteral& lit) { sum += lit.value; }
+
+    int64_t sum = 0;
+};
+
+TEST_CASE("ast") {
+    std::string source;
+    while (source.size() < (8 << 20))
+        source += "value := (first + 42) * call(second, -third, 7) - [2]int / (x + 0x1f)\n";
+
+    W::FileId file = W::SourceManager::global().add("bench.w", W::SourceBuffer::borrow(source));
+    W::Lexer lexer(file);
+    W::TokenStream token_stream(lexer);
+    W::utils::Arena arena;
+    W::Diagnostics diagnostics;
+    W::Parser parser(token_stream, arena, diagnostics);
+
+    std::vector<W::Ast::StatementPtr> statements;
+    while (token_stream.peek().kind != W::TokenKind::Eof)
+        statements.push_back(parser.next());
+
+    W::Ast::FlatTree tree = W::Ast::FlatTree::build(file, statements);
+
+    BENCHMARK("flatten 8MB") {
+        return W::Ast::FlatTree::build(file, statements).size();
+    };
+
+    BENCHMARK("sum literals walking the pointer tree") {
+        SumLiterals pass;
+        for (W::Ast::StatementPtr statement : statements)
+            pass.walk(statement);
+        return pass.sum;
+    };
+
+    BENCHMARK("count nodes with the virtual visitor") {
+        CountNodesVirtual pass;
+        pass.handle_statement(statements);
+        return pass.count;
+    };
+
+    BENCHMARK("count nodes with the static visitor") {
+        CountNodesStatic pass;
+        pass.dispatch(std::span(statements));
+        return pass.count;
+    };
+
+    BENCHMARK("sum literals with the static visitor") {
+        SumLiteralsStatic pass;
+        pass.dispatch(std::span(statements));
+        return pass.sum;
+    };
+
+    // the 8MB tree does not fit in the caches, the walks above wait for the
+    // memory more than they dispatch
+    std::string_view small_source = std::string_view(source).substr(0, source.find('\n', 64 << 10) + 1);
+    W::FileId small_file = W::SourceManager::global().add("small.w", W::SourceBuffer::borrow(small_source));
+    W::Lexer small_lexer(small_file);
+    W::TokenStream small_stream(small_lexer);
+    W::Parser small_parser(small_stream, arena, diagnostics);
+
+    std::vector<W::Ast::StatementPtr> small_statements;
+    while (small_stream.peek().kind != W::TokenKind::Eof)
+        small_statements.push_back(small_parser.next());
+
+    BENCHMARK("count nodes of 64KB with the virtual visitor") {
+        CountNodesVirtual pass;
+        pass.handle_statement(small_statements);
+        return pass.count;
+    };
+
+    BENCHMARK("count nodes of 64KB with the static visitor") {
+        CountNodesStatic pass;
+        pass.dispatch(std::span(small_statements));
+        return pass.count;
+    };
+
+    BENCHMARK("sum literals scanning the flat tree") {
+        int64_t sum = 0;
+        for (const W::Ast::Flat::IntLiteral& literal : tree.nodes<W::Ast::Flat::IntLiteral>())
+            sum += literal.value;
+        return sum;
+    };
+
+    BENCHMARK("count binary nodes walking the pointer tree") {
+        struct CountBinaries : SumLiterals {
+            void visit(W::Ast::BinaryExpression& expr) override { count++; walk(expr.left); walk(expr.right); }
+            std::size_t count = 0;
+        } pass;
+        for (W::Ast::StatementPtr statement : statements)
+            pass.walk(statement);
+        return pass.count;
+    };
+
+    BENCHMARK("count additions scanning the flat tree") {
+        std::size_t count = 0;
+        for (const W::Ast::Flat::BinaryExpression& binary : tree.nodes<W::Ast::Flat::BinaryExpression>())
+            count += binary.op == W::Ast::BinaryOp::Add;
+        return count;
+    };
+
+    // a warm cache against the lexer and the parser
+    std::filesystem::path directory = std::filesystem::temp_directory_path() / "w_ast_cache_bench";
+    W::Ast::AstCache cache(directory);
+    cache.store(tree);
+
+    BENCHMARK("load 8MB from the AST cache") {
+        return cache.load(file)->size();
+    };
+
+    BENCHMARK("lex and parse 8MB") {
+        W::Lexer lexer(file);
+        W::TokenStream token_stream(lexer);
+        W::utils::Arena arena;
+        W::Diagnostics diagnostics;
+        W::Parser parser(token_stream, arena, diagnostics);
+
+        std::size_t count = 0;
+        while (token_stream.peek().kind != W::TokenKind::Eof)
+            count += parser.next() != nullptr;
+        return count;
+    };
+
+    std::filesystem::remove_all(directory);
+}
@@ -0,0 +1,222 @@
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <string_view>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_test_macros.hpp>
+
+#include <frontend/incremental_parser.hpp>
+#include <frontend/lexer.hpp>
+#include <frontend/parallel_lexer.hpp>
+#include <frontend/parallel_parser.hpp>
+#include <frontend/parser.hpp>
+#include <frontend/pipelined_lexer.hpp>
+#include <frontend/source_buffer.hpp>
+#include <frontend/stream_reader.hpp>
+#include <frontend/token_stream.hpp>
+
+static std::string repeat(std::string_view pattern, std::size_t size) {
+    std::string data;
+    data.reserve(size + pattern.size());
+    while (data.size() < size)
+        data.append(pattern);
+    return data;
+}
+
+static std::size_t parse_all(W::TokenStream& token_stream) {
+    W::utils::Arena arena;
+    W::Diagnostics diagnostics;
+    W::Parser parser(token_stream, arena, diagnostics);
+
+    std::size_t count = 0;
+    for (; token_stream.peek().kind != W::TokenKind::Eof; count++)
+        parser.next();
+    return count;
+}
+
+static std::size_t lex_all(std::string_view source) {
+    W::Lexer lexer("bench.w", W::SourceBuffer::borrow(source));
+
+    std::size_t count = 0;
+    while (lexer.next().kind != W::TokenKind::Eof)
+        count++;
+    return count;
+}
+
+TEST_CASE("lexer") {
+    std::string operators = repeat(
+        "a>>>=b>>>c<<=d<<e>>=f>>g>=h>i<=j<k==l!=m:=n+=o-=p/=q*=r^=s%=t|=u&=v\n"
+        "x=(a+b)*(c-d)/e%f^~g&&h||i&j|k;y=!z;w++;v--;a.b..c...d,#[e]@f?g:h\n",
+        1 << 20
+    );
+    std::string identifiers = repeat(
+        "fn compute_value(mut first_argument Int, second_argument Float) Int {\n"
+        "    result := first_argument + second_argument // trailing comment\n"
+        "    /* block comment with /* nesting */ inside */ return result\n"
+        "}\n",
+        1 << 20
+    );
+
+    std::string strings = repeat(
+        "    \"<div class=row>{name} with a fairly long template body that goes on and on, holding {value} and {other}</div>\",\n"
+        "    \"<li>{item} from the embedded table, then a tab\\tand a \\\"quoted\\\" word before the end of the row</li>\",\n",
+        1 << 20
+    );
+
+    BENCHMARK("operator dense 1MB") {
+        return lex_all(operators);
+    };
+
+    BENCHMARK("identifiers and comments 1MB") {
+        return lex_all(identifiers);
+    };
+
+    BENCHMARK("string heavy 1MB") {
+        return lex_all(strings);
+    };
+
+    BENCHMARK("batch lex_all 1MB") {
+        W::Lexer lexer("bench.w", W::SourceBuffer::borrow(identifiers));
+        return lexer.lex_all().size();
+    };
+
+    std::string big = repeat(identifiers, 32 << 20);
+    W::FileId big_file = W::SourceManager::global().add("bench.w", W::SourceBuffer::borrow(big));
+
+    BENCHMARK("sequential lex_all 32MB") {
+        return W::Lexer(big_file).lex_all().size();
+    };
+
+    BENCHMARK("parallel lex_all 32MB") {
+        return W::ParallelLexer(big_file).lex_all().size();
+    };
+
+    // 100k lines, an identifier in the middle gains then loses a character
+    std::string lines = repeat("    result := first_argument + second_argument // comment\n", 100000 * 57);
+    W::FileId original = W::SourceManager::global().add("bench.w", W::SourceBuffer::borrow(lines));
+    W::TextEdit insert = { static_cast<uint32_t>(lines.size() / 2 + 4), 0, "x" };
+    W::TextEdit remove = { insert.offset, 1, "" };
+    W::FileId edited = W::SourceManager::global().add("bench.w", W::SourceBuffer::borrow(lines));
+    W::TokenBuffer tokens = W::Lexer(edited).lex_all();
+
+    BENCHMARK("edit and relex one character in 100k lines") {
+        W::SourceManager::global().edit(edited, insert);
+        W::Lexer::relex(tokens, edited, insert);
+        W::SourceManager::global().edit(edited, remove);
+        W::Lexer::relex(tokens, edited, remove);
+        return tokens.size();
+    };
+
+    BENCHMARK("lex_all 100k lines") {
+        return W::Lexer(original).lex_all().size();
+    };
+
+    std::string declarations = repeat("result := first_argument + second_argument // comment\n", 20000 * 54);
+    W::FileId declarations_file = W::SourceManager::global().add("bench.w", W::SourceBuffer::borrow(declarations));
+    W::TokenBuffer declarations_tokens = W::Lexer(declarations_file).lex_all();
+    W::IncrementalParser incremental(W::SourceManager::global().add("bench.w", W::SourceBuffer::borrow(declarations)));
+    uint32_t edited_line = static_cast<uint32_t>(declarations.size() / 2 / 54 * 54 + 14);
+
+    BENCHMARK("reparse one character in 20k lines") {
+        incremental.edit(W::TextEdit { edited_line, 0, "x" });
+        incremental.edit(W::TextEdit { edited_line, 1, "" });
+        return incremental.statements().size();
+    };
+
+    // what the edits cost without reuse: the whole file is parsed again
+    BENCHMARK("relex and parse 20k lines after one character") {
+        W::SourceManager::global().edit(declarations_file, W::TextEdit { edited_line, 0, "x" });
+        W::Lexer::relex(declarations_tokens, declarations_file, W::TextEdit { edited_line, 0, "x" });
+        W::TokenStream first(declarations_tokens);
+        std::size_t statements = parse_all(first);
+
+        W::SourceManager::global().edit(declarations_file, W::TextEdit { edited_line, 1, "" });
+        W::Lexer::relex(declarations_tokens, declarations_file, W::TextEdit { edited_line, 1, "" });
+        W::TokenStream second(declarations_tokens);
+        return statements + parse_all(second);
+    };
+
+    // same bytes through a file descriptor (as a pipe would) and a mapping
+    std::filesystem::path stream_path = std::filesystem::temp_directory_path() / "w_stream_bench.w";
+    {
+        std::ofstream output(stream_path, std::ios::binary);
+        output << repeat(identifiers, 8 << 20);
+    }
+
+    BENCHMARK("mapped lex_all 8MB") {
+        return W::Lexer(stream_path, W::SourceBuffer::map_file(stream_path)).lex_all().size();
+    };
+
+    BENCHMARK("streamed lex_stream 8MB") {
+        int fd = open(stream_path.c_str(), O_RDONLY);
+        W::StreamReader reader(fd);
+        std::size_t size = W::Lexer::lex_stream(stream_path, reader).size();
+        close(fd);
+        return size;
+    };
+
+    std::filesystem::remove(stream_path);
+
+    // lexing overlaps parsing on another core
+    std::string statements = repeat("value := (first_argument + 42) * second_argument - \"text\" / 0x1f\n", 8 << 20);
+    W::FileId statements_file = W::SourceManager::global().add("bench.w", W::SourceBuffer::borrow(statements));
+
+    BENCHMARK("parse 8MB pulling from the lexer") {
+        W::Lexer lexer(statements_file);
+        W::TokenStream token_stream(lexer);
+        return parse_all(token_stream);
+    };
+
+    BENCHMARK("parse 8MB from a pipelined lexer") {
+        W::PipelinedLexer lexer(statements_file);
+        W::TokenStream token_stream(lexer);
+        return parse_all(token_stream);
+    };
+
+    // the top level statements are split between the cores
+    W::TokenBuffer statements_tokens = W::Lexer(statements_file).lex_all();
+
+    BENCHMARK("parse 8MB from a token buffer") {
+        W::TokenStream token_stream(statements_tokens);
+        return parse_all(token_stream);
+    };
+
+    BENCHMARK("parallel parse 8MB from a token buffer") {
+        W::utils::Arena arena;
+        W::Diagnostics diagnostics;
+        return W::ParallelParser(statements_tokens).parse_all(arena, diagnostics).size();
+    };
+
+    // an outline only needs the signatures, the bodies are skipped
+    std::string functions = repeat(
+        "fn compute(first Int, second Float) Int {\n"
+        "    value := (first + 42) * second - \"text\" / 0x1f\n"
+        "    other := call(value, -first, [2]int) + value.member.field\n"
+        "    last := (value * other) / (first - second) + call(other)\n"
+        "}\n",
+        8 << 20
+    );
+    W::FileId functions_file = W::SourceManager::global().add("bench.w", W::SourceBuffer::borrow(functions));
+    W::TokenBuffer functions_tokens = W::Lexer(functions_file).lex_all();
+
+    BENCHMARK("parse 8MB of functions") {
+        W::TokenStream token_stream(functions_tokens);
+        return parse_all(token_stream);
+    };
+
+    BENCHMARK("parse 8MB of functions with lazy bodies") {
+        W::TokenStream token_stream(functions_tokens);
+        W::utils::Arena arena;
+        W::Diagnostics diagnostics;
+        W::Parser parser(token_stream, arena, diagnostics, W::Parser::Options { .lazy_bodies = true });
+
+        std::size_t count = 0;
+        for (; token_stream.peek().kind != W::TokenKind::Eof; count++)
+            parser.next();
+        return count;
+    };
+}
@@ -0,0 +1,58 @@
+#ifndef W_DIAGNOSTICS_HPP
+#define W_DIAGNOSTICS_HPP
+
+#include <cstddef>
+#include <span>
+#include <string_view>
+#include <vector>
+
+#include <errors.hpp>
+#include <location.hpp>
+#include <utils/arena.hpp>
+
+namespace W {
+    struct Diagnostic {
+        ExceptionType type;
+        Location location;
+        // stored in the arena of the Diagnostics
+        std::string_view message;
+    };
+
+    // collects the errors of a compilation instead of throwing them, so a
+    // single run reports every error; the message is formatted when the
+    // error is reported and kept in an arena
+    struct Diagnostics {
+    public:
+        Diagnostics() = default;
+        Diagnostics(const Diagnostics&) = delete;
+        Diagnostics(Diagnostics&&) noexcept = default;
+        ~Diagnostics() = default;
+
+        Diagnostics& operator=(const Diagnostics&) = delete;
+        Diagnostics& operator=(Diagnostics&&) noexcept = default;
+
+        // Error is an error of error_list.hpp, i.e. ParserExpectedTokenError
+        template<typename Error, typename... Args>
+        inline void report(Location location, Args&&... args);
+
+        // copies the diagnostics of other after the ones of this
+        void append(const Diagnostics& other);
+        void append(std::span<const Diagnostic> diagnostics);
+
+        inline bool empty() const;
+        inline std::size_t size() const;
+        inline std::span<const Diagnostic> all() const;
+
+        // orders the diagnostics by file then by position, the order of the
+        // reports is kept for a same position
+        void sort();
+
+    private:
+        utils::Arena m_arena;
+        std::vector<Diagnostic> m_diagnostics;
+    };
+}
+
+#include <diagnostics.inl>
+
+#endif
@@ -0,0 +1,26 @@
+#include <utility>
+
+namespace W {
+    template<typename Error, typename... Args>
+    inline void Diagnostics::report(Location location, Args&&... args) {
+        Error error(location, std::forward<Args>(args)...);
+
+        m_diagnostics.push_back(Diagnostic {
+            .type = error.get_type(),
+            .location = location,
+            .message = m_arena.make_string(error.get_message()),
+        });
+    }
+
+    inline bool Diagnostics::empty() const {
+        return m_diagnostics.empty();
+    }
+
+    inline std::size_t Diagnostics::size() const {
+        return m_diagnostics.size();
+    }
+
+    inline std::span<const Diagnostic> Diagnostics::all() const {
+        return m_diagnostics;
+    }
+}
@@ -0,0 +1,85 @@
+#ifndef W_DRIVER_HPP
+#define W_DRIVER_HPP
+
+#include <cstddef>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+#include <diagnostics.hpp>
+
+namespace W {
+    // lexes and parses a set of source files, each file is a task of a
+    // work-stealing pool; a single file uses the threads itself instead, it
+    // is split by ParallelLexer and ParallelParser on a pool of `jobs`
+    // threads when it is big enough or lexed ahead of the parser by a
+    // PipelinedLexer
+    //
+    // the files are processed in any order but sorted by path, the
+    // diagnostics come out in the same order whatever the number of jobs
+    //
+    // with a cache directory, a file parsed before without error is loaded
+    // from its Ast::AstCache instead of lexed and parsed
+    struct Driver {
+    public:
+        struct Options {
+            // 0 uses every hardware thread
+            unsigned jobs = 0;
+            // empty without cache
+            std::filesystem::path cache;
+        };
+
+        // a file which could not be read or processed
+        struct Failure {
+            std::filesystem::path path;
+            std::string message;
+        };
+
+        Driver(Options options);
+        Driver(const Driver&) = delete;
+        Driver(Driver&&) noexcept = default;
+        ~Driver() = default;
+
+        Driver& operator=(const Driver&) = delete;
+        Driver& operator=(Driver&&) noexcept = default;
+
+        // a directory adds every `.w` file below it, `-` is the standard
+        // input
+        void add(const std::filesystem::path& path);
+
+        // false if a file has an error or could not be processed, it is
+        // called once
+        bool run();
+
+        inline std::size_t files() const;
+        // top level statements parsed without error
+        inline std::size_t statements() const;
+        // files loaded from the cache
+        inline std::size_t cached() const;
+        // sorted by path, then by position in the file
+        inline const Diagnostics& diagnostics() const;
+        inline const std::vector<Failure>& failures() const;
+
+    private:
+        struct Unit {
+            std::filesystem::path path;
+            Diagnostics diagnostics;
+            std::size_t statements = 0;
+            bool cached = false;
+            std::string failure;
+        };
+
+        void process(Unit& unit, unsigned threads) const;
+
+        Options m_options;
+        std::vector<std::filesystem::path> m_paths;
+        std::size_t m_statements;
+        std::size_t m_cached;
+        Diagnostics m_diagnostics;
+        std::vector<Failure> m_failures;
+    };
+}
+
+#include <driver.inl>
+
+#endif
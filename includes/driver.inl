@@ -0,0 +1,21 @@
+namespace W {
+    inline std::size_t Driver::files() const {
+        return m_paths.size();
+    }
+
+    inline std::size_t Driver::statements() const {
+        return m_statements;
+    }
+
+    inline std::size_t Driver::cached() const {
+        return m_cached;
+    }
+
+    inline const Diagnostics& Driver::diagnostics() const {
+        return m_diagnostics;
+    }
+
+    inline const std::vector<Driver::Failure>& Driver::failures() const {
+        return m_failures;
+    }
+}
@@ -2,8 +2,15 @@
 #error You must define WLANG_ERROR before including this file
 #endif
 
+#define WLANG_LEXER_ERROR(name, message, ...) WLANG_ERROR(Lexer ## name, message, __VA_ARGS__)
 #define WLANG_PARSER_ERROR(name, message, ...) WLANG_ERROR(Parser ## name, message, __VA_ARGS__)
 
+WLANG_LEXER_ERROR(LiteralOutOfRange, "the literal `{}` does not fit in 64 bits", std::string)
+WLANG_LEXER_ERROR(InvalidLiteral, "invalid numeric literal `{}`", std::string)
+WLANG_LEXER_ERROR(InvalidUtf8, "the source is not valid UTF-8")
+WLANG_LEXER_ERROR(InvalidEscape, "invalid escape sequence in `{}`", std::string)
+WLANG_LEXER_ERROR(UnterminatedString, "unterminated string or rune")
+
 WLANG_PARSER_ERROR(ExpectedToken, "expected token {}, got {}", TokenKind, TokenKind)
 WLANG_PARSER_ERROR(UnexpectedToken, "unexpected token {}", TokenKind)
 WLANG_PARSER_ERROR(EmptyRune, "a rune cannot be empty")
@@ -11,10 +18,12 @@ WLANG_PARSER_ERROR(RuneIsNotAString, "the rune `{}` is not a string, please repl
 WLANG_PARSER_ERROR(IllFormedRune, "invalid rune `{}`", std::string)
 WLANG_PARSER_ERROR(UnsupportedPrefixDec, "prefix decrementation is unsupported")
 WLANG_PARSER_ERROR(UnsupportedPrefixInc, "prefix incrementation is unsupported")
+WLANG_PARSER_ERROR(NestingTooDeep, "the code is nested more than {} levels deep", std::size_t)
 
 // WLANG_PARSER_ERROR(PubInNonPublishableContext, "invalid pub, this pub is used in a context where pub is not usable (i.e. in a function body)")
 WLANG_PARSER_ERROR(UnexpectedConstMutability, "const declaration cannot be constant and mutable at the same time")
 WLANG_PARSER_ERROR(UnexpectedTypeMutability, "type declaration cannot mutable")
 
+#undef WLANG_LEXER_ERROR
 #undef WLANG_PARSER_ERROR
 #undef WLANG_ERROR
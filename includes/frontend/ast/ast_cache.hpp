@@ -0,0 +1,68 @@
+#ifndef W_AST_CACHE_HPP
+#define W_AST_CACHE_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <string_view>
+
+#include <source_manager.hpp>
+#include <frontend/ast/flat_tree.hpp>
+
+namespace W::Ast {
+    // directory of the FlatTrees of the files already parsed, a tree is
+    // stored in a file named after the hash of its source and s_flat_version,
+    // the same source is then loaded instead of parsed again
+    //
+    // a file is an image of the arrays of the tree: a header, a table of
+    // sections and the arrays aligned on 8 bytes; the handles and ranges are
+    // indices so the arrays are copied as they are from the mapped file, only
+    // the symbols are relocated (they are stored as indices in a table of
+    // names interned again by the load); a loaded tree is checked like any
+    // input, every handle, range and location must stay in its array
+    //
+    // only the trees without error are stored, a file with errors is parsed
+    // again for its diagnostics
+    struct AstCache {
+    public:
+        AstCache(std::filesystem::path directory);
+        AstCache(const AstCache&) = delete;
+        AstCache(AstCache&&) noexcept = default;
+        ~AstCache() = default;
+
+        AstCache& operator=(const AstCache&) = delete;
+        AstCache& operator=(AstCache&&) noexcept = default;
+
+        // hash of a source in the name of its file
+        static uint64_t key(std::string_view source);
+
+        // nullopt if the source was not stored, by this version, or if its
+        // file is not a valid tree of the source
+        std::optional<FlatTree> load(FileId file) const;
+        // the directory is created if needed, a failure to write is ignored
+        // (the source is parsed again the next time)
+        void store(const FlatTree& tree) const;
+
+        inline const std::filesystem::path& directory() const;
+
+    private:
+        // calls f on every array of the tree, in the order of the sections
+        template<typename Tree, typename F>
+        static void for_each_array(Tree& tree, F&& f);
+
+        // hash of the version, of the size of every array element and of the
+        // LocationStorage of every node kind
+        static uint64_t layout();
+        // the nodes reached from the roots are every node once (no cycle nor
+        // sharing), with their children, ranges and locations in bounds
+        static bool valid(const FlatTree& tree, std::size_t source_size);
+        std::filesystem::path path(std::string_view source) const;
+
+        std::filesystem::path m_directory;
+    };
+}
+
+#include <frontend/ast/ast_cache.inl>
+
+#endif
@@ -0,0 +1,5 @@
+namespace W::Ast {
+    inline const std::filesystem::path& AstCache::directory() const {
+        return m_directory;
+    }
+}
@@ -2,15 +2,14 @@
 #ifndef W_EXPRESSION_TYPE_HPP
 #define W_EXPRESSION_TYPE_HPP
 
-#include <memory>
 #include <variant>
 
 namespace W::Ast {
     struct Expression;
-    using ExpressionPtr = std::unique_ptr<Expression>;
+    using ExpressionPtr = Expression*;
 
     struct Type;
-    using TypePtr = std::unique_ptr<Type>;
+    using TypePtr = Type*;
 
     template<bool Optional = false>
     struct ExpressionType {
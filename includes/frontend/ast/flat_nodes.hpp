@@ -0,0 +1,202 @@
+#ifndef W_AST_FLAT_NODES_HPP
+#define W_AST_FLAT_NODES_HPP
+
+#include <cstdint>
+
+#include <symbols.hpp>
+#include <frontend/ast/node_enums.hpp>
+#include <frontend/ast/nodes.hpp>
+#include <utils/types.hpp>
+
+namespace W::Ast {
+    // handle of a node of a FlatTree: its NodeType in the high bits and its
+    // index in the array of its kind in the others, 0 is the null handle
+    struct NodeHandle {
+        static constexpr uint32_t s_index_bits = 27;
+        static constexpr uint32_t s_max_index = (uint32_t(1) << s_index_bits) - 1;
+
+        static inline NodeHandle make(NodeType type, uint32_t index);
+
+        inline NodeType type() const;
+        inline uint32_t index() const;
+        inline explicit operator bool() const;
+
+        bool operator==(const NodeHandle&) const = default;
+
+        uint32_t value = 0;
+    };
+
+    // elements [begin, begin + size) of a side array of a FlatTree
+    struct FlatRange {
+        uint32_t begin = 0;
+        uint32_t size = 0;
+    };
+
+    // version of the flat format, AstCache only loads the trees stored with
+    // the same one: bump it with any change of the Flat nodes below, of their
+    // LocationStorage or of what the parser builds from a source
+    inline constexpr uint32_t s_flat_version = 2;
+
+    // what a FlatTree keeps of the location of a node kind, the rest is
+    // recovered from the children or by lexing the source again
+    enum struct LocationStorage : uint8_t {
+        // begin and end, for the statements whose end cannot be recovered
+        // (a function body may have lost statements to errors)
+        Span,
+        // the begin, the end is the end of the last child or of the token
+        // at the begin
+        Begin,
+        // nothing, the node starts with its first child and ends with its
+        // last child or the closing bracket after it
+        None,
+    };
+
+    // same nodes as nodes.hpp without vtable nor location (kept in a parallel
+    // array of the tree, see s_location), the children are handles and the
+    // lists are ranges of FlatTree::children; the small fields come last so
+    // they share the padding
+    namespace Flat {
+        struct AccessIdentifierExpression {
+            static constexpr LocationStorage s_location = LocationStorage::None;
+
+            FlatRange members;
+        };
+
+        struct CallExpression {
+            static constexpr LocationStorage s_location = LocationStorage::None;
+
+            NodeHandle callee;
+            FlatRange params;
+        };
+
+        struct BinaryExpression {
+            static constexpr LocationStorage s_location = LocationStorage::None;
+
+            NodeHandle left;
+            NodeHandle right;
+            BinaryOp op;
+        };
+
+        struct UnaryExpression {
+            static constexpr LocationStorage s_location = LocationStorage::Begin;
+
+            NodeHandle expr;
+            UnaryOp op;
+        };
+
+        struct IdentExpression {
+            static constexpr LocationStorage s_location = LocationStorage::Begin;
+
+            SymbolId value;
+        };
+
+        struct ParentExpression {
+            static constexpr LocationStorage s_location = LocationStorage::Begin;
+
+            NodeHandle expr;
+        };
+
+        struct ArrayTypeExpression {
+            static constexpr LocationStorage s_location = LocationStorage::Begin;
+
+            NodeHandle lenght;
+            NodeHandle inner_type;
+        };
+
+        struct SliceTypeExpression {
+            static constexpr LocationStorage s_location = LocationStorage::Begin;
+
+            NodeHandle inner_type;
+        };
+
+        struct BoolLiteral {
+            static constexpr LocationStorage s_location = LocationStorage::Begin;
+
+            bool value;
+        };
+
+        struct IntLiteral {
+            static constexpr LocationStorage s_location = LocationStorage::Begin;
+
+            int64_t value;
+        };
+
+        // the raw spelling is the source of its location, see FlatTree::raw
+        struct FloatLiteral {
+            static constexpr LocationStorage s_location = LocationStorage::Begin;
+
+            float64_t value;
+        };
+
+        struct EnumVariantLiteral {
+            static constexpr LocationStorage s_location = LocationStorage::Begin;
+
+            SymbolId value;
+        };
+
+        struct RuneLiteral {
+            static constexpr LocationStorage s_location = LocationStorage::Begin;
+
+            char32_t value;
+        };
+
+        // bytes of FlatTree::string
+        struct StringLiteral {
+            static constexpr LocationStorage s_location = LocationStorage::Begin;
+
+            FlatRange value;
+        };
+
+        struct ExpressionStatement {
+            static constexpr LocationStorage s_location = LocationStorage::None;
+
+            NodeHandle expr;
+            bool is_pub;
+        };
+
+        // range of FlatTree::parameters, its locations are parallel to it
+        struct Parameter {
+            VariableModifiers modifiers;
+            SymbolId name;
+            NodeHandle type;
+        };
+
+        struct DeclareFunctionStatement {
+            static constexpr LocationStorage s_location = LocationStorage::Span;
+
+            SymbolId name;
+            // null without return type
+            NodeHandle return_type;
+            FlatRange parameters;
+            FlatRange body;
+            bool is_pub;
+        };
+
+        struct DeclareVariableStatement {
+            static constexpr LocationStorage s_location = LocationStorage::Span;
+
+            VariableModifiers modifiers;
+            SymbolId name;
+            NodeHandle value;
+            bool is_pub;
+        };
+    }
+
+    inline NodeHandle NodeHandle::make(NodeType type, uint32_t index) {
+        return NodeHandle { static_cast<uint32_t>(type) << s_index_bits | index };
+    }
+
+    inline NodeType NodeHandle::type() const {
+        return static_cast<NodeType>(value >> s_index_bits);
+    }
+
+    inline uint32_t NodeHandle::index() const {
+        return value & s_max_index;
+    }
+
+    inline NodeHandle::operator bool() const {
+        return value != 0;
+    }
+}
+
+#endif
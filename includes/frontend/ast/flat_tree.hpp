@@ -0,0 +1,123 @@
+#ifndef W_AST_FLAT_TREE_HPP
+#define W_AST_FLAT_TREE_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+#include <location.hpp>
+#include <source_manager.hpp>
+#include <frontend/ast/flat_nodes.hpp>
+#include <frontend/ast/nodes.hpp>
+
+namespace W::Ast {
+    struct AstCache;
+    struct FlatTreeBuilder;
+
+    // data oriented version of the AST of a file: the nodes of a kind are
+    // stored together in an array, addressed by 32-bit NodeHandles, with
+    // what is stored of their locations (see LocationStorage) in a parallel
+    // array; the lists of children are ranges of a shared array of handles
+    //
+    // the arrays are generated from node_list.hpp, a pass only interested in
+    // some kinds scans their arrays linearly instead of walking the tree
+    struct FlatTree {
+    public:
+        // byte range of a node in the file of the tree
+        struct Span {
+            uint32_t begin;
+            uint32_t end;
+        };
+
+        template<typename T>
+        using StoredLocation = std::conditional_t<T::s_location == LocationStorage::Span, Span, uint32_t>;
+
+        template<typename T>
+        struct NodeArray {
+            std::vector<T> nodes;
+            // parallel to the nodes, empty for LocationStorage::None
+            std::vector<StoredLocation<T>> locations;
+        };
+
+        FlatTree(FileId file);
+        FlatTree(const FlatTree&) = delete;
+        FlatTree(FlatTree&&) noexcept = default;
+        ~FlatTree() = default;
+
+        FlatTree& operator=(const FlatTree&) = delete;
+        FlatTree& operator=(FlatTree&&) noexcept = default;
+
+        // flattens the statements parsed from a file, the pointer tree (and
+        // its arena) may be freed afterwards
+        static FlatTree build(FileId file, std::span<const StatementPtr> statements);
+        // same with the locations of statements[i] and its nodes relative to
+        // bases[i], as IncrementalParser keeps them
+        static FlatTree build(FileId file, std::span<const StatementPtr> statements, std::span<const uint32_t> bases);
+
+        inline FileId file() const;
+        // top level statements in the order of the file
+        inline std::span<const NodeHandle> roots() const;
+        // number of nodes of every kind
+        std::size_t size() const;
+
+        // every node of the kind T (a Flat:: node) in creation order
+        template<typename T>
+        inline std::span<const T> nodes() const;
+        template<typename T>
+        inline const T& get(NodeHandle handle) const;
+        // calls f(node, handle) with the Flat:: node of the handle, which must
+        // not be null
+        template<typename F>
+        inline decltype(auto) visit(NodeHandle handle, F&& f) const;
+
+        // the part not stored is recovered from the children, or by lexing
+        // the token at the begin or the closing bracket after the last child
+        inline Location location(NodeHandle handle) const;
+        // source bytes of the node
+        inline std::string_view raw(NodeHandle handle) const;
+
+        inline std::span<const NodeHandle> children(FlatRange range) const;
+        inline std::span<const Flat::Parameter> parameters(FlatRange range) const;
+        inline Location parameter_location(FlatRange range, std::size_t index) const;
+        inline std::string_view string(FlatRange range) const;
+
+        template<typename T>
+        static constexpr NodeType type_of();
+        // bytes taken by a node of the kind T, its stored location included
+        template<typename T>
+        static constexpr std::size_t node_size();
+
+    private:
+        friend struct AstCache;
+        friend struct FlatTreeBuilder;
+
+        template<typename T>
+        inline NodeArray<T>& array();
+        template<typename T>
+        inline const NodeArray<T>& array() const;
+        Span span(NodeHandle handle) const;
+        uint32_t begin(NodeHandle handle) const;
+        uint32_t end(NodeHandle handle) const;
+
+        template<typename T>
+        NodeHandle add(T node, const Location& location);
+
+        FileId m_file;
+        std::vector<NodeHandle> m_roots;
+        std::vector<NodeHandle> m_children;
+        std::vector<Flat::Parameter> m_parameters;
+        std::vector<Span> m_parameter_locations;
+        std::string m_strings;
+
+        #define WLANG_AST(X, C) NodeArray<Flat::X##C> m_##X##C;
+        #include <frontend/ast/node_list.hpp>
+    };
+}
+
+#include <frontend/ast/flat_tree.inl>
+
+#endif
@@ -0,0 +1,92 @@
+#include <type_traits>
+#include <utility>
+
+#include <utils/utility.hpp>
+
+namespace W::Ast {
+    template<typename>
+    inline constexpr bool s_dependent_false = false;
+
+    inline FileId FlatTree::file() const {
+        return m_file;
+    }
+
+    inline std::span<const NodeHandle> FlatTree::roots() const {
+        return m_roots;
+    }
+
+    template<typename T>
+    constexpr NodeType FlatTree::type_of() {
+        #define WLANG_AST(X, C) if constexpr (std::is_same_v<T, Flat::X##C>) return NodeType::X##C; else
+        #include <frontend/ast/node_list.hpp>
+        static_assert(s_dependent_false<T>, "not a node of a FlatTree");
+    }
+
+    template<typename T>
+    constexpr std::size_t FlatTree::node_size() {
+        if constexpr (T::s_location == LocationStorage::None)
+            return sizeof(T);
+        else
+            return sizeof(T) + sizeof(StoredLocation<T>);
+    }
+
+    template<typename T>
+    inline FlatTree::NodeArray<T>& FlatTree::array() {
+        #define WLANG_AST(X, C) if constexpr (std::is_same_v<T, Flat::X##C>) return m_##X##C; else
+        #include <frontend/ast/node_list.hpp>
+        static_assert(s_dependent_false<T>, "not a node of a FlatTree");
+    }
+
+    template<typename T>
+    inline const FlatTree::NodeArray<T>& FlatTree::array() const {
+        return const_cast<FlatTree*>(this)->array<T>();
+    }
+
+    template<typename T>
+    inline std::span<const T> FlatTree::nodes() const {
+        return array<T>().nodes;
+    }
+
+    template<typename T>
+    inline const T& FlatTree::get(NodeHandle handle) const {
+        assert(handle.type() == type_of<T>());
+        return array<T>().nodes[handle.index()];
+    }
+
+    template<typename F>
+    inline decltype(auto) FlatTree::visit(NodeHandle handle, F&& f) const {
+        switch (handle.type()) {
+            #define WLANG_AST(X, C) case NodeType::X##C: \
+                return std::forward<F>(f)(m_##X##C.nodes[handle.index()], handle);
+            #include <frontend/ast/node_list.hpp>
+            default: utils::unreachable();
+        }
+    }
+
+    inline Location FlatTree::location(NodeHandle handle) const {
+        Span bytes = span(handle);
+        return Location { m_file, bytes.begin, bytes.end };
+    }
+
+    inline std::string_view FlatTree::raw(NodeHandle handle) const {
+        Span bytes = span(handle);
+        return SourceManager::global().file(m_file).content().substr(bytes.begin, bytes.end - bytes.begin);
+    }
+
+    inline std::span<const NodeHandle> FlatTree::children(FlatRange range) const {
+        return std::span<const NodeHandle>(m_children).subspan(range.begin, range.size);
+    }
+
+    inline std::span<const Flat::Parameter> FlatTree::parameters(FlatRange range) const {
+        return std::span<const Flat::Parameter>(m_parameters).subspan(range.begin, range.size);
+    }
+
+    inline Location FlatTree::parameter_location(FlatRange range, std::size_t index) const {
+        Span bytes = m_parameter_locations[range.begin + index];
+        return Location { m_file, bytes.begin, bytes.end };
+    }
+
+    inline std::string_view FlatTree::string(FlatRange range) const {
+        return std::string_view(m_strings).substr(range.begin, range.size);
+    }
+}
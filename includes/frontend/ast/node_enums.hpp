@@ -1,8 +1,10 @@
 #ifndef W_AST_ENUMS_HPP
 #define W_AST_ENUMS_HPP
 
+#include <cstdint>
+
 namespace W::Ast {
-    enum struct UnaryOp {
+    enum struct UnaryOp : uint8_t {
         Plus,   // +a
         Minus,  // -a
         Not,    // !a
@@ -11,7 +13,7 @@ namespace W::Ast {
         Option, // ?a
     };
 
-    enum struct BinaryOp {
+    enum struct BinaryOp : uint8_t {
         BitwiseAnd,         // a & b
         BitwiseOr,          // a | b
         BitwiseXor,         // a ^ b
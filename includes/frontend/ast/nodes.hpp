@@ -1,16 +1,20 @@
 #ifndef W_AST_HPP
 #define W_AST_HPP
 
-#include <memory>
-#include <string>
-#include <vector>
-#include <optional>
+#include <cstdint>
+#include <span>
+#include <string_view>
 
 #include <location.hpp>
+#include <symbols.hpp>
 #include <frontend/ast/node_enums.hpp>
 #include <frontend/ast/expression_type.hpp>
 #include <utils/types.hpp>
 
+namespace W {
+    struct TokenBuffer;
+}
+
 namespace W::Passes {
     struct VisitorPass;
 }
@@ -25,21 +29,34 @@ namespace W::Ast {
         Volatile = 1 << 4,
     };
 
+    // the nodes live in the utils::Arena of their module, they are never
+    // destroyed so they must not own anything: the children are pointers
+    // and spans into the same arena, the strings are views into the source
+    // or the literal table
     struct Node {
-        Node() = default;
+        Node(NodeType type):
+            m_type(type)
+        {}
         Node(const Node&) = delete;
         Node(Node&&) noexcept = default;
-        virtual ~Node() = default;
+        ~Node() = default;
 
         Node& operator=(const Node&) = delete;
         Node& operator=(Node&&) noexcept = default;
 
-        virtual NodeType get_type() const = 0;
+        // kept in the node, a switch on it needs no virtual call (see
+        // Passes::StaticPass)
+        NodeType get_type() const {
+            return m_type;
+        }
         virtual void visit(Passes::VisitorPass& visitor) = 0;
 
-        Location location;
+        Location location = {};
+
+    private:
+        NodeType m_type;
     };
-    using NodePtr = std::unique_ptr<Node>;
+    using NodePtr = Node*;
 
     // TYPES
 
@@ -48,165 +65,178 @@ namespace W::Ast {
 
         // virtual size_t get_id() const = 0;
     };
-    using TypePtr = std::unique_ptr<Type>;
+    using TypePtr = Type*;
 
     // EXPRESSIONS
 
     struct Expression : Node {
+        using Node::Node;
         ~Expression() = default;
     };
-    using ExpressionPtr = std::unique_ptr<Expression>;
+    using ExpressionPtr = Expression*;
 
     struct AccessIdentifierExpression : Expression {
-        NodeType get_type() const override;
+        AccessIdentifierExpression(): Expression(NodeType::AccessIdentifierExpression) {}
         void visit(Passes::VisitorPass& visitor) override;
 
-        std::vector<ExpressionPtr> members;
+        std::span<ExpressionPtr> members;
     };
 
     struct CallExpression : Expression {
-        NodeType get_type() const override;
+        CallExpression(): Expression(NodeType::CallExpression) {}
         void visit(Passes::VisitorPass& visitor) override;
 
-        ExpressionPtr callee;
-        std::vector<ExpressionPtr> params;
+        ExpressionPtr callee = {};
+        std::span<ExpressionPtr> params;
     };
 
     struct BinaryExpression : Expression {
-        NodeType get_type() const override;
+        BinaryExpression(): Expression(NodeType::BinaryExpression) {}
         void visit(Passes::VisitorPass& visitor) override;
 
-        BinaryOp op;
-        ExpressionPtr left;
-        ExpressionPtr right;
+        BinaryOp op = {};
+        ExpressionPtr left = {};
+        ExpressionPtr right = {};
     };
 
     struct UnaryExpression : Expression {
-        NodeType get_type() const override;
+        UnaryExpression(): Expression(NodeType::UnaryExpression) {}
         void visit(Passes::VisitorPass& visitor) override;
 
-        UnaryOp op;
-        ExpressionPtr expr;
+        UnaryOp op = {};
+        ExpressionPtr expr = {};
     };
     
     struct IdentExpression : Expression {
-        NodeType get_type() const override;
+        IdentExpression(): Expression(NodeType::IdentExpression) {}
         void visit(Passes::VisitorPass& visitor) override;
         
-        std::string value;
+        SymbolId value = {};
     };
     
     struct ParentExpression : Expression {
-        NodeType get_type() const override;
+        ParentExpression(): Expression(NodeType::ParentExpression) {}
         void visit(Passes::VisitorPass& visitor) override;
         
-        ExpressionPtr expr;
+        ExpressionPtr expr = {};
     };
 
     // TYPE EXPRESSIONS
 
     struct ArrayTypeExpression : Expression {
-        NodeType get_type() const override;
+        ArrayTypeExpression(): Expression(NodeType::ArrayTypeExpression) {}
         void visit(Passes::VisitorPass& visitor) override;
 
-        ExpressionPtr lenght;
-        ExpressionPtr inner_type;
+        ExpressionPtr lenght = {};
+        ExpressionPtr inner_type = {};
     };
 
     struct SliceTypeExpression : Expression {
-        NodeType get_type() const override;
+        SliceTypeExpression(): Expression(NodeType::SliceTypeExpression) {}
         void visit(Passes::VisitorPass& visitor) override;
 
-        ExpressionPtr inner_type;
+        ExpressionPtr inner_type = {};
     };
 
     // LITERALS
 
     struct BoolLiteral : Expression {
-        NodeType get_type() const override;
+        BoolLiteral(): Expression(NodeType::BoolLiteral) {}
         void visit(Passes::VisitorPass& visitor) override;
 
-        bool value;
+        bool value = {};
     };
 
     struct IntLiteral : Expression {
-        NodeType get_type() const override;
+        IntLiteral(): Expression(NodeType::IntLiteral) {}
         void visit(Passes::VisitorPass& visitor) override;
 
-        int64_t value;
+        int64_t value = {};
     };
 
     struct FloatLiteral : Expression {
-        NodeType get_type() const override;
+        FloatLiteral(): Expression(NodeType::FloatLiteral) {}
         void visit(Passes::VisitorPass& visitor) override;
 
-        float64_t value;
+        float64_t value = {};
         // needed to avoid issue due to the precission of a float (during the
         // translation into C)
-        std::string raw;
+        std::string_view raw = {};
     };
 
     struct EnumVariantLiteral : Expression {
-        NodeType get_type() const override;
+        EnumVariantLiteral(): Expression(NodeType::EnumVariantLiteral) {}
         void visit(Passes::VisitorPass& visitor) override;
 
-        std::string value;
+        SymbolId value = {};
     };
 
     struct RuneLiteral : Expression {
-        NodeType get_type() const override;
+        RuneLiteral(): Expression(NodeType::RuneLiteral) {}
         void visit(Passes::VisitorPass& visitor) override;
 
-        char32_t value;
+        char32_t value = {};
     };
 
     struct StringLiteral : Expression {
-        NodeType get_type() const override;
+        StringLiteral(): Expression(NodeType::StringLiteral) {}
         void visit(Passes::VisitorPass& visitor) override;
 
-        std::string value;
+        std::string_view value = {};
     };
 
     // STATEMENTS
     
     struct Statement : Node {
+        using Node::Node;
         ~Statement() = default;
 
-        bool is_pub;
+        bool is_pub = {};
     };
-    using StatementPtr = std::unique_ptr<Statement>;
+    using StatementPtr = Statement*;
 
     struct ExpressionStatement : Statement {
-        NodeType get_type() const override;
+        ExpressionStatement(): Statement(NodeType::ExpressionStatement) {}
         void visit(Passes::VisitorPass& visitor) override;
 
-        ExpressionPtr expr;
+        ExpressionPtr expr = {};
+    };
+
+    // tokens of a function body skipped by a parser with lazy bodies, the
+    // body stays empty until Parser::parse_body parses them
+    struct LazyBody {
+        const TokenBuffer* tokens;
+        // the tokens between the braces
+        uint32_t begin;
+        uint32_t end;
     };
 
     struct DeclareFunctionStatement : Statement {
         struct Parameter {
             Location location;
             VariableModifiers modifiers;
-            std::string name;
+            SymbolId name;
             ExpressionType<> type;
         };
         
-        NodeType get_type() const override;
+        DeclareFunctionStatement(): Statement(NodeType::DeclareFunctionStatement) {}
         void visit(Passes::VisitorPass& visitor) override;
 
-        std::string name;
+        SymbolId name = {};
         ExpressionType<true> return_type;
-        std::vector<Parameter> parameters;
-        std::vector<StatementPtr> body;
+        std::span<Parameter> parameters;
+        std::span<StatementPtr> body;
+        // not null while the body is not parsed
+        LazyBody* lazy_body = {};
     };
 
     struct DeclareVariableStatement : Statement {
-        NodeType get_type() const override;
+        DeclareVariableStatement(): Statement(NodeType::DeclareVariableStatement) {}
         void visit(Passes::VisitorPass& visitor) override;
         
-        VariableModifiers modifiers;
-        std::string name;
-        ExpressionPtr value;
+        VariableModifiers modifiers = {};
+        SymbolId name = {};
+        ExpressionPtr value = {};
     };
 
     inline constexpr VariableModifiers operator&(VariableModifiers lhs, VariableModifiers rhs) {
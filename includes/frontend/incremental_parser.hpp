@@ -0,0 +1,90 @@
+#ifndef W_INCREMENTAL_PARSER_HPP
+#define W_INCREMENTAL_PARSER_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string_view>
+#include <vector>
+
+#include <diagnostics.hpp>
+#include <source_manager.hpp>
+#include <frontend/ast/nodes.hpp>
+#include <frontend/source_buffer.hpp>
+#include <frontend/token_buffer.hpp>
+#include <utils/arena.hpp>
+
+namespace W {
+    // AST of a file being edited, the file is split in top level
+    // declarations like ParallelParser does and the statements of every
+    // declaration are kept with a hash of the source of its tokens
+    //
+    // after an edit the tokens are relexed around it, then a declaration
+    // whose source is unchanged takes the statements (and diagnostics) of
+    // the previous version as they are: the locations of its nodes are
+    // relative to the declaration, so only its offset moves; the other
+    // declarations are parsed again
+    //
+    // the replaced nodes stay in the arena until the reparsed tokens reach
+    // twice the size of the file, then everything is parsed again in a new
+    // arena
+    struct IncrementalParser {
+    public:
+        IncrementalParser(FileId file);
+        IncrementalParser(const IncrementalParser&) = delete;
+        IncrementalParser(IncrementalParser&&) noexcept = default;
+        ~IncrementalParser() = default;
+
+        IncrementalParser& operator=(const IncrementalParser&) = delete;
+        IncrementalParser& operator=(IncrementalParser&&) noexcept = default;
+
+        // applies the edit to the file
+        void edit(const TextEdit& edit);
+
+        // the edited file, it keeps its FileId across edits
+        inline FileId file() const;
+        inline const TokenBuffer& tokens() const;
+        // the statements parsed without error, in order
+        inline std::span<const Ast::StatementPtr> statements() const;
+        // parallel to the statements, the offset of their declaration which
+        // is added to the locations of a statement and of its nodes
+        inline std::span<const uint32_t> bases() const;
+        // in the order of the file
+        inline std::span<const Diagnostic> diagnostics() const;
+        // declarations taken from the previous version by the last edit
+        inline std::size_t reused() const;
+
+    private:
+        struct Declaration {
+            std::size_t hash;
+            // from its first token to the start of the next declaration (or
+            // the Eof), where the Eof of its parse is
+            uint32_t begin;
+            uint32_t end;
+            // their locations are relative to begin
+            std::span<Ast::StatementPtr> statements;
+            std::span<Diagnostic> diagnostics;
+        };
+
+        // splits the tokens in declarations and reuses the previous ones
+        // which are unchanged by the edit, removed holds the bytes it removed
+        void parse(std::vector<Declaration>& previous, const TextEdit& edit, std::string_view removed);
+        Declaration parse_declaration(std::size_t begin, std::size_t end);
+
+        FileId m_file;
+        TokenBuffer m_tokens;
+        utils::Arena m_arena;
+        // tokens parsed in the arena
+        std::size_t m_parsed;
+
+        std::vector<Declaration> m_declarations;
+        std::vector<Ast::StatementPtr> m_statements;
+        std::vector<uint32_t> m_bases;
+        std::vector<Diagnostic> m_diagnostics;
+        std::size_t m_reused;
+    };
+}
+
+#include <frontend/incremental_parser.inl>
+
+#endif
@@ -0,0 +1,25 @@
+namespace W {
+    inline FileId IncrementalParser::file() const {
+        return m_file;
+    }
+
+    inline const TokenBuffer& IncrementalParser::tokens() const {
+        return m_tokens;
+    }
+
+    inline std::span<const Ast::StatementPtr> IncrementalParser::statements() const {
+        return m_statements;
+    }
+
+    inline std::span<const uint32_t> IncrementalParser::bases() const {
+        return m_bases;
+    }
+
+    inline std::span<const Diagnostic> IncrementalParser::diagnostics() const {
+        return m_diagnostics;
+    }
+
+    inline std::size_t IncrementalParser::reused() const {
+        return m_reused;
+    }
+}
@@ -1,36 +1,37 @@
 #ifndef W_LEXER_HPP
 #define W_LEXER_HPP
 
+#include <cstdint>
 #include <iostream>
 #include <variant>
 #include <fstream>
 #include <sstream>
 #include <memory>
 #include <string>
-#include <array>
+#include <string_view>
+#include <vector>
 #include <fmt/core.h>
 
 #include <utils/types.hpp>
 #include <location.hpp>
+#include <source_manager.hpp>
+#include <symbols.hpp>
+#include <frontend/source_buffer.hpp>
+#include <frontend/stream_reader.hpp>
+#include <frontend/token.hpp>
+#include <frontend/token_buffer.hpp>
 
 namespace W {
-    enum struct TokenKind {
-        #define WLANG_TOKEN(X) X,
-
-        #include <frontend/token_list.hpp>
-    };
-
-    struct Token {
-        Location location;
-
-        TokenKind kind;
-        std::string raw;
-    };
-
-    const size_t LEXER_BUFFER_SIZE = 10;
     struct Lexer {
     public:
+        // the input is fully loaded in memory, prefer the SourceBuffer
+        // constructor with a mapped file for big inputs
         Lexer(std::filesystem::path path, std::istream& input);
+        // registers the source in the global SourceManager
+        Lexer(std::filesystem::path path, SourceBuffer source);
+        // starts lexing at the given byte offset of the file, the offset must
+        // not fall in the middle of a token
+        Lexer(FileId file, uint32_t offset = 0);
         Lexer(const Lexer&) = delete;
         Lexer(Lexer&&) noexcept = default;
         ~Lexer() = default;
@@ -39,32 +40,57 @@ namespace W {
         Lexer& operator=(Lexer&&) noexcept = default;
 
         Token next();
+        // lexes every remaining token, the last one is always Eof
+        TokenBuffer lex_all();
         bool finished();
 
+        // updates tokens, lexed from the file before the edit, to the edited
+        // file by relexing only from the last token the edit may change until
+        // the new tokens line up with the previous ones again
+        static void relex(TokenBuffer& tokens, FileId file, const TextEdit& edit);
+
+        // lexes the input while it is read, the source is registered in the
+        // global SourceManager once the input ends
+        static TokenBuffer lex_stream(std::filesystem::path path, StreamReader& input);
+
+        inline std::string_view raw(const Token& token) const;
+        inline Location location(const Token& token) const;
+        inline FileId file() const;
+
     private:
+        // lexes bytes which are not registered yet, m_file is invalid
+        Lexer(std::string_view window);
+
         bool start_with(std::string_view sv);
         char buffer_at(std::size_t i = 0);
         void advance(size_t offset = 1);
+        void advance_to(const char* target);
         void skip_whitespace();
 
         void read_ident(Token& token);
+        void skip_digits();
         void read_number(Token& token);
+        void read_operator(Token& token);
         void read_string_or_rune(Token& token, char open_quote);
         void read_comment(bool is_multiline);
 
-        std::shared_ptr<std::filesystem::path> m_path;
-        std::array<char, LEXER_BUFFER_SIZE> m_working_buffer;
-        std::istream& m_input;
-        std::size_t m_line = 1;
-        std::size_t m_col = 1;
+        FileId m_file;
+        std::string_view m_source;
+        const char* m_cursor;
+        const char* m_end;
     };
-}
 
-template <> struct fmt::formatter<W::TokenKind>: formatter<std::string_view> {
-  // parse is inherited from formatter<std::string_view>.
+    inline std::string_view Lexer::raw(const Token& token) const {
+        return token.raw(m_source);
+    }
+
+    inline Location Lexer::location(const Token& token) const {
+        return token.location(m_file);
+    }
 
-  auto format(W::TokenKind kind, format_context& ctx) const
-    -> format_context::iterator;
-};
+    inline FileId Lexer::file() const {
+        return m_file;
+    }
+}
 
 #endif
@@ -0,0 +1,62 @@
+#ifndef W_PARALLEL_LEXER_HPP
+#define W_PARALLEL_LEXER_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+#include <source_manager.hpp>
+#include <frontend/token_buffer.hpp>
+#include <utils/thread_pool.hpp>
+
+namespace W {
+    // lexes a big file by splitting it in chunks lexed on several threads,
+    // the result is exactly the token sequence of Lexer::lex_all
+    //
+    // every chunk but the first starts at a guessed position (the start of a
+    // line, moved after a `*/` which seems to close a comment) and may be
+    // wrong if it falls in a string, a rune or a comment; the chunks are then
+    // stitched in order by relexing sequentially from the real end of the
+    // previous chunk until a token starts at the same offset as one of the
+    // speculative tokens, from there both sequences are the same
+    struct ParallelLexer {
+    public:
+        struct Options {
+            // smaller files are lexed sequentially
+            std::size_t threshold = 16 * 1024 * 1024;
+            // a chunk is never smaller than this
+            std::size_t min_chunk_size = 4 * 1024 * 1024;
+            // 0 uses every hardware thread, ignored with a pool
+            unsigned threads = 0;
+            // the chunks run on this pool when given (it must outlive the
+            // lexer), else on a pool made for the call
+            utils::ThreadPool* pool = nullptr;
+        };
+
+        ParallelLexer(FileId file);
+        ParallelLexer(FileId file, Options options);
+        ParallelLexer(const ParallelLexer&) = delete;
+        ParallelLexer(ParallelLexer&&) noexcept = default;
+        ~ParallelLexer() = default;
+
+        ParallelLexer& operator=(const ParallelLexer&) = delete;
+        ParallelLexer& operator=(ParallelLexer&&) noexcept = default;
+
+        // the last token is always Eof
+        TokenBuffer lex_all();
+
+    private:
+        std::size_t threads() const;
+        std::vector<uint32_t> chunk_starts() const;
+        uint32_t speculative_start(uint32_t boundary) const;
+        TokenBuffer lex_chunk(uint32_t begin, uint32_t end) const;
+        TokenBuffer stitch(std::vector<TokenBuffer>& chunks, const std::vector<uint32_t>& starts) const;
+
+        FileId m_file;
+        std::string_view m_source;
+        Options m_options;
+    };
+}
+
+#endif
@@ -0,0 +1,84 @@
+#ifndef W_PARALLEL_PARSER_HPP
+#define W_PARALLEL_PARSER_HPP
+
+#include <cstddef>
+#include <vector>
+
+#include <diagnostics.hpp>
+#include <frontend/ast/nodes.hpp>
+#include <frontend/token_buffer.hpp>
+#include <utils/arena.hpp>
+#include <utils/thread_pool.hpp>
+
+namespace W {
+    // parses the top level statements of a big file on several threads, the
+    // result is exactly the statements of a Parser reading the whole buffer
+    //
+    // a pre-scan over the kinds of the tokens finds where the top level
+    // declarations start (a declaration keyword or `name :=` outside of any
+    // bracket), the file is split in chunks at these boundaries and every
+    // chunk is parsed into its own arena, then the arenas, the statements
+    // and the diagnostics are merged in the order of the file
+    //
+    // a boundary is only where the Parser starts a statement if the
+    // statement before it ends there: when the last statement of a chunk has
+    // an error (the recovery of the Parser may skip past the boundary) it is
+    // parsed again with the tokens after it, until a statement ends at the
+    // start of a chunk
+    struct ParallelParser {
+    public:
+        struct Options {
+            // smaller buffers are parsed sequentially
+            std::size_t threshold = 1024 * 1024;
+            // a chunk never has less tokens than this
+            std::size_t min_chunk_size = 256 * 1024;
+            // 0 uses every hardware thread, ignored with a pool
+            unsigned threads = 0;
+            // the chunks run on this pool when given (it must outlive the
+            // parser), else on a pool made for the call
+            utils::ThreadPool* pool = nullptr;
+        };
+
+        // the buffer must outlive the parser
+        ParallelParser(const TokenBuffer& tokens);
+        ParallelParser(const TokenBuffer& tokens, Options options);
+        ParallelParser(const ParallelParser&) = delete;
+        ParallelParser(ParallelParser&&) noexcept = default;
+        ~ParallelParser() = default;
+
+        ParallelParser& operator=(const ParallelParser&) = delete;
+        ParallelParser& operator=(ParallelParser&&) noexcept = default;
+
+        // the nodes are owned by the arena, the statements with an error are
+        // reported and left out like Parser::next does
+        std::vector<Ast::StatementPtr> parse_all(utils::Arena& arena, Diagnostics& diagnostics);
+
+        // index of the first token of every top level declaration, in order;
+        // an expression statement belongs to the declaration before it
+        static std::vector<std::size_t> boundaries(const TokenBuffer& tokens);
+
+    private:
+        struct Chunk {
+            utils::Arena arena;
+            Diagnostics diagnostics;
+            std::vector<Ast::StatementPtr> statements;
+
+            // the last statement, it may have ended at the end of the chunk
+            // instead of going on with the tokens after it
+            std::size_t last_begin = 0;
+            std::size_t last_statements = 0;
+            std::size_t last_diagnostics = 0;
+            // it was parsed without error
+            bool last_clean = true;
+        };
+
+        std::size_t threads() const;
+        std::vector<std::size_t> chunk_starts() const;
+        void parse_chunk(std::size_t begin, std::size_t end, Chunk& chunk) const;
+
+        const TokenBuffer* m_tokens;
+        Options m_options;
+    };
+}
+
+#endif
@@ -4,16 +4,33 @@
 #include <array>
 #include <cstddef>
 #include <cstdint>
+#include <optional>
+#include <span>
 #include <vector>
 
+#include <diagnostics.hpp>
 #include <frontend/ast/nodes.hpp>
 #include <frontend/lexer.hpp>
 #include <frontend/token_stream.hpp>
+#include <utils/arena.hpp>
 
 namespace W {
     struct Parser {
     public:
-        Parser(TokenStream& token_stream);
+        // deepest nesting of expressions (parentheses, arguments, array
+        // lengths) and functions
+        static constexpr std::size_t s_max_depth = 256;
+
+        struct Options {
+            // the bodies of the functions are skipped by brace matching and
+            // kept as LazyBody, only with a stream over a token buffer
+            bool lazy_bodies = false;
+        };
+
+        // the nodes are allocated in the arena, which owns the whole AST, the
+        // errors are reported to the diagnostics
+        Parser(TokenStream& token_stream, utils::Arena& arena, Diagnostics& diagnostics);
+        Parser(TokenStream& token_stream, utils::Arena& arena, Diagnostics& diagnostics, Options options);
         Parser(const Parser&) = delete;
         Parser(Parser&&) noexcept = default;
         ~Parser() = default;
@@ -21,17 +38,45 @@ namespace W {
         Parser& operator=(const Parser&) = delete;
         Parser& operator=(Parser&&) noexcept = default;
 
+        // nullptr for a statement with an error, the tokens are then skipped
+        // until the start of the next statement (a declaration keyword, a
+        // `}` or a new line)
         Ast::StatementPtr next();
 
+        // parses the body of a function skipped by a parser with lazy bodies,
+        // nothing is done once it is parsed; the token buffer must still be
+        // alive
+        static void parse_body(Ast::DeclareFunctionStatement& function, utils::Arena& arena, Diagnostics& diagnostics);
+
     private:
+        struct DepthGuard;
+
+        // prefix operator or `[` (with the length of an array type) waiting
+        // for its operand
+        struct Prefix {
+            Token token;
+            Ast::UnaryOp op;
+            Ast::ExpressionPtr length;
+        };
+
+        // reports the error and leaves the token when it is not expected
         template<std::size_t N>
-        const Token& expected(std::array<TokenKind, N> kind);
-        const Token& expected(TokenKind kind);
+        bool expected(std::array<TokenKind, N> kind, Token* result = nullptr);
+        bool expected(TokenKind kind, Token* result = nullptr);
         
         template<std::size_t N>
         bool start_by(std::array<TokenKind, N> kind);
         bool start_by(TokenKind kind);
 
+        bool starts_line(const Token& token);
+        void synchronize(const Token& start);
+
+        // moves the elements pushed on a scratch stack since base to the arena
+        template<typename T>
+        std::span<T> take(std::vector<T>& stack, std::size_t base);
+
+        // the parsing functions return nullptr once an error is reported
+        Ast::StatementPtr parse_statement();
         Ast::StatementPtr parse_func_declaration();
         Ast::StatementPtr parse_var_like_declaration();
         // Ast::StatementPtr parse_enum_declaration();
@@ -39,12 +84,17 @@ namespace W {
         // Ast::StatementPtr parse_defer();
         // Ast::StatementPtr parse_struct_declaration();
 
+        // the binary operators and the prefixes of an operand are parsed
+        // iteratively, only the nested expressions recurse
         Ast::ExpressionPtr parse_expr(int precedence = 0);
-        Ast::ExpressionPtr parse_binary(int precedence, Ast::ExpressionPtr lhs);
         Ast::ExpressionPtr parse_unary();
         Ast::ExpressionPtr parse_access(Ast::ExpressionPtr member);
         Ast::ExpressionPtr parse_primitive();
         Ast::ExpressionPtr parse_bool();
+        // reports the error of a literal the lexer could not decode
+        bool check_literal(const Token& token);
+        // decoded content of a string or a rune
+        std::string_view string_literal(const Token& token);
         Ast::ExpressionPtr parse_int();
         Ast::ExpressionPtr parse_float();
         Ast::ExpressionPtr parse_rune();
@@ -52,9 +102,23 @@ namespace W {
         Ast::ExpressionPtr parse_ident();
         Ast::ExpressionPtr parse_enum_variant();
 
-        std::vector<Ast::ExpressionPtr> parse_expr_list(TokenKind termination_token, Location* termination_location);
+        std::optional<std::span<Ast::ExpressionPtr>> parse_expr_list(TokenKind termination_token, Location* termination_location);
 
         TokenStream& m_token_stream;
+        utils::Arena& m_arena;
+        Diagnostics& m_diagnostics;
+        Options m_options;
+        bool m_checked_utf8;
+        std::size_t m_depth;
+
+        // the children of a node are collected here then copied at once to
+        // the arena, the nested lists are pushed on top and removed before
+        // the next child is pushed
+        std::vector<Ast::ExpressionPtr> m_expressions;
+        std::vector<Ast::StatementPtr> m_statements;
+        std::vector<Ast::DeclareFunctionStatement::Parameter> m_parameters;
+        std::vector<Token> m_operators;
+        std::vector<Prefix> m_prefixes;
     };
 }
 
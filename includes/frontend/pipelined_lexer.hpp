@@ -0,0 +1,80 @@
+#ifndef W_PIPELINED_LEXER_HPP
+#define W_PIPELINED_LEXER_HPP
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <thread>
+
+#include <source_manager.hpp>
+#include <frontend/token.hpp>
+#include <utils/spsc_ring.hpp>
+
+namespace W {
+    // lexes a file on its own thread while the tokens are consumed, i.e. by
+    // the parser through a TokenStream, so lexing and parsing overlap
+    //
+    // the tokens are published by batches in a lock-free single producer /
+    // single consumer ring, the consumer only touches an atomic once per
+    // batch
+    struct PipelinedLexer {
+    public:
+        PipelinedLexer(FileId file);
+        PipelinedLexer(const PipelinedLexer&) = delete;
+        PipelinedLexer(PipelinedLexer&&) = delete;
+        // stops the lexer thread if the tokens were not all consumed
+        ~PipelinedLexer();
+
+        PipelinedLexer& operator=(const PipelinedLexer&) = delete;
+        PipelinedLexer& operator=(PipelinedLexer&&) = delete;
+
+        // the Eof token is repeated after the end, an error thrown by the
+        // lexer thread is rethrown here once the tokens before it are consumed
+        inline Token next();
+
+        inline FileId file() const;
+
+    private:
+        static constexpr std::size_t s_batch_size = 4096;
+        static constexpr std::size_t s_batch_count = 8;
+
+        // the ring holds 512KB of batches, on the heap and never zeroed since
+        // the lexer thread writes a batch before publishing it
+        struct Batch {
+            std::array<Token, s_batch_size> tokens;
+            uint32_t size;
+            // the lexer thread publishes nothing after this batch
+            bool last;
+        };
+
+        void produce();
+        Token next_batch();
+
+        FileId m_file;
+        utils::SpscRing<Batch, s_batch_count> m_ring;
+        std::atomic<bool> m_stop = false;
+        std::exception_ptr m_error;
+
+        // batch being consumed, owned by the consumer until it is released
+        Batch* m_batch = nullptr;
+        uint32_t m_read = 0;
+        bool m_finished = false;
+        Token m_eof {};
+
+        std::thread m_thread;
+    };
+
+    inline Token PipelinedLexer::next() {
+        if (m_batch != nullptr && m_read < m_batch->size) [[likely]]
+            return m_batch->tokens[m_read++];
+        return next_batch();
+    }
+
+    inline FileId PipelinedLexer::file() const {
+        return m_file;
+    }
+}
+
+#endif
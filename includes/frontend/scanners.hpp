@@ -0,0 +1,51 @@
+#ifndef W_SCANNERS_HPP
+#define W_SCANNERS_HPP
+
+#include <cstdint>
+#include <vector>
+
+namespace W::Scanners {
+    // every scanner returns a pointer to the first byte of [begin, end) that
+    // does not belong to the scanned run, or end if the run reaches the end
+    using Scanner = const char* (*)(const char* begin, const char* end);
+
+    enum struct Isa {
+        Scalar,
+        Sse2,
+        Avx2,
+    };
+
+    struct Table {
+        // stops on the first byte which is not ' ', \t, \n, \v, \f or \r
+        Scanner skip_whitespace;
+        // stops on the first byte which is not [a-zA-Z0-9_]
+        Scanner skip_ident;
+        // stops on \n or \0
+        Scanner find_line_end;
+        // stops on '*', '/' or \0, used to walk nested block comments
+        Scanner find_comment_delimiter;
+        // stops on '"', '\'', '`', '\\' or \0, used to walk string and rune bodies
+        Scanner find_string_delimiter;
+        // stops on the first byte of an invalid UTF-8 sequence
+        Scanner validate_utf8;
+        // appends the offset (from begin) of the byte following every \n
+        void (*collect_line_starts)(const char* begin, const char* end, std::vector<uint32_t>& starts);
+    };
+
+    bool is_supported(Isa isa);
+    const Table& table(Isa isa);
+    // table of the best instruction set supported by the running cpu
+    inline const Table& table();
+
+    inline const char* skip_whitespace(const char* begin, const char* end);
+    inline const char* skip_ident(const char* begin, const char* end);
+    inline const char* find_line_end(const char* begin, const char* end);
+    inline const char* find_comment_delimiter(const char* begin, const char* end);
+    inline const char* find_string_delimiter(const char* begin, const char* end);
+    inline const char* validate_utf8(const char* begin, const char* end);
+    inline void collect_line_starts(const char* begin, const char* end, std::vector<uint32_t>& starts);
+}
+
+#include <frontend/scanners.inl>
+
+#endif
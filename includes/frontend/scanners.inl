@@ -0,0 +1,36 @@
+namespace W::Scanners {
+    const Table& select_best_table();
+
+    inline const Table& table() {
+        static const Table& best = select_best_table();
+        return best;
+    }
+
+    inline const char* skip_whitespace(const char* begin, const char* end) {
+        return table().skip_whitespace(begin, end);
+    }
+
+    inline const char* skip_ident(const char* begin, const char* end) {
+        return table().skip_ident(begin, end);
+    }
+
+    inline const char* find_line_end(const char* begin, const char* end) {
+        return table().find_line_end(begin, end);
+    }
+
+    inline const char* find_comment_delimiter(const char* begin, const char* end) {
+        return table().find_comment_delimiter(begin, end);
+    }
+
+    inline const char* find_string_delimiter(const char* begin, const char* end) {
+        return table().find_string_delimiter(begin, end);
+    }
+
+    inline const char* validate_utf8(const char* begin, const char* end) {
+        return table().validate_utf8(begin, end);
+    }
+
+    inline void collect_line_starts(const char* begin, const char* end, std::vector<uint32_t>& starts) {
+        table().collect_line_starts(begin, end, starts);
+    }
+}
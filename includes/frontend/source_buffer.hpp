@@ -0,0 +1,69 @@
+#ifndef W_SOURCE_BUFFER_HPP
+#define W_SOURCE_BUFFER_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <istream>
+#include <string_view>
+
+namespace W {
+    // replaces the removed bytes at offset by the inserted ones
+    struct TextEdit {
+        uint32_t offset;
+        uint32_t removed;
+        std::string_view inserted;
+    };
+
+    // contiguous view over a whole source file, the memory is either
+    // memory-mapped, owned (loaded from a stream or edited) or borrowed from
+    // the caller, the data never moves so views into it stay valid as long as
+    // the buffer is alive (even after a move of the buffer itself) and not
+    // edited
+    struct SourceBuffer {
+    public:
+        static SourceBuffer map_file(const std::filesystem::path& path);
+        static SourceBuffer load(std::istream& input);
+        static SourceBuffer borrow(std::string_view data);
+        // owned copy of source with the edit applied, with some room left for
+        // the following edits
+        static SourceBuffer edit(std::string_view source, const TextEdit& edit);
+
+        SourceBuffer(const SourceBuffer&) = delete;
+        SourceBuffer(SourceBuffer&& other) noexcept;
+        ~SourceBuffer();
+
+        SourceBuffer& operator=(const SourceBuffer&) = delete;
+        SourceBuffer& operator=(SourceBuffer&& other) noexcept;
+
+        inline const char* data() const;
+        inline std::size_t size() const;
+        inline std::string_view view() const;
+
+        // edits an owned buffer with room for it in place, only the bytes
+        // after the edit move; any other buffer is replaced by an edited copy
+        void apply(const TextEdit& edit);
+
+    private:
+        friend struct StreamReader;
+
+        enum struct Storage {
+            Borrowed,
+            Owned,
+            Mapped,
+        };
+
+        SourceBuffer(const char* data, std::size_t size, Storage storage, std::size_t capacity = 0);
+        void release();
+
+        const char* m_data;
+        std::size_t m_size;
+        // bytes allocated for an owned buffer
+        std::size_t m_capacity;
+        Storage m_storage;
+    };
+}
+
+#include <frontend/source_buffer.inl>
+
+#endif
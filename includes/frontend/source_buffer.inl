@@ -0,0 +1,13 @@
+namespace W {
+    inline const char* SourceBuffer::data() const {
+        return m_data;
+    }
+
+    inline std::size_t SourceBuffer::size() const {
+        return m_size;
+    }
+
+    inline std::string_view SourceBuffer::view() const {
+        return std::string_view(m_data, m_size);
+    }
+}
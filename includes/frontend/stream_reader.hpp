@@ -0,0 +1,63 @@
+#ifndef W_STREAM_READER_HPP
+#define W_STREAM_READER_HPP
+
+#include <cstddef>
+#include <istream>
+#include <string_view>
+
+#include <frontend/source_buffer.hpp>
+
+namespace W {
+    // reads an input which cannot be mapped (stdin, a pipe) by big chunks into
+    // a growing heap buffer, the lexer works on the bytes already read while
+    // the rest of the input is still coming; a refill may move the bytes, the
+    // tokens only keep offsets into them
+    struct StreamReader {
+    public:
+        static constexpr std::size_t s_default_chunk_size = 256 * 1024;
+        static constexpr std::size_t s_min_chunk_size = 64 * 1024;
+
+        StreamReader(int fd, std::size_t chunk_size = s_default_chunk_size);
+        StreamReader(std::istream& input, std::size_t chunk_size = s_default_chunk_size);
+        StreamReader(const StreamReader&) = delete;
+        StreamReader(StreamReader&& other) noexcept;
+        ~StreamReader();
+
+        StreamReader& operator=(const StreamReader&) = delete;
+        StreamReader& operator=(StreamReader&&) noexcept = delete;
+
+        // reads at least count bytes (a chunk by default) unless the input
+        // ends before, returns false once the input is exhausted; the
+        // previous views are invalidated
+        bool refill(std::size_t count = 0);
+        inline std::string_view view() const;
+        inline bool exhausted() const;
+
+        // reads the rest of the input and hands the bytes over
+        SourceBuffer finish();
+
+    private:
+        StreamReader(int fd, std::istream* input, std::size_t chunk_size);
+        std::size_t read_some(char* data, std::size_t count);
+        void reserve(std::size_t capacity);
+
+        int m_fd;
+        std::istream* m_input;
+        std::size_t m_chunk_size;
+
+        char* m_data;
+        std::size_t m_size;
+        std::size_t m_capacity;
+        bool m_exhausted;
+    };
+
+    inline std::string_view StreamReader::view() const {
+        return std::string_view(m_data, m_size);
+    }
+
+    inline bool StreamReader::exhausted() const {
+        return m_exhausted;
+    }
+}
+
+#endif
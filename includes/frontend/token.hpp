@@ -0,0 +1,50 @@
+#ifndef W_TOKEN_HPP
+#define W_TOKEN_HPP
+
+#include <cstdint>
+#include <string_view>
+#include <fmt/core.h>
+
+#include <literals.hpp>
+#include <location.hpp>
+#include <symbols.hpp>
+
+namespace W {
+    enum struct TokenKind : uint8_t {
+        #define WLANG_TOKEN(X) X,
+
+        #include <frontend/token_list.hpp>
+    };
+
+    // packed token, the text and the location are derived from the source
+    // on demand
+    struct Token {
+        inline SymbolId symbol() const;
+        inline LiteralId literal() const;
+        // text of an identifier, a number, or the content of a string or a
+        // rune (without the quotes, escapes not decoded), empty for the other
+        // tokens
+        inline std::string_view raw(std::string_view source) const;
+        inline Location location(FileId file) const;
+
+        // byte range of the token in the source
+        uint32_t offset;
+        uint32_t length;
+        // symbol id of an identifier, literal id of a number, a string or a
+        // rune
+        uint32_t payload;
+        TokenKind kind;
+    };
+    static_assert(sizeof(Token) == 16);
+}
+
+template <> struct fmt::formatter<W::TokenKind>: formatter<std::string_view> {
+  // parse is inherited from formatter<std::string_view>.
+
+  auto format(W::TokenKind kind, format_context& ctx) const
+    -> format_context::iterator;
+};
+
+#include <frontend/token.inl>
+
+#endif
@@ -0,0 +1,28 @@
+namespace W {
+    inline SymbolId Token::symbol() const {
+        return static_cast<SymbolId>(payload);
+    }
+
+    inline LiteralId Token::literal() const {
+        return static_cast<LiteralId>(payload);
+    }
+
+    inline std::string_view Token::raw(std::string_view source) const {
+        switch (kind) {
+            case TokenKind::Ident:
+            case TokenKind::Integer:
+            case TokenKind::Float:
+                return source.substr(offset, length);
+            case TokenKind::String:
+            case TokenKind::Rune:
+                // opening and closing quotes
+                return source.substr(offset + 1, length - 2);
+            default:
+                return std::string_view();
+        }
+    }
+
+    inline Location Token::location(FileId file) const {
+        return Location{file, offset, offset + length};
+    }
+}
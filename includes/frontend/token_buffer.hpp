@@ -0,0 +1,72 @@
+#ifndef W_TOKEN_BUFFER_HPP
+#define W_TOKEN_BUFFER_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string_view>
+#include <vector>
+
+#include <location.hpp>
+#include <source_manager.hpp>
+#include <frontend/token.hpp>
+
+namespace W {
+    // tokens of a whole file stored as a struct of arrays, a scan over one of
+    // the columns (i.e. the kinds when looking for braces) only touches the
+    // bytes it needs
+    struct TokenBuffer {
+    public:
+        TokenBuffer(FileId file);
+        // tokens of a source which is not registered yet (i.e. still
+        // streamed), see bind
+        TokenBuffer();
+        TokenBuffer(const TokenBuffer&) = delete;
+        TokenBuffer(TokenBuffer&&) noexcept = default;
+        ~TokenBuffer() = default;
+
+        TokenBuffer& operator=(const TokenBuffer&) = delete;
+        TokenBuffer& operator=(TokenBuffer&&) noexcept = default;
+
+        inline FileId file() const;
+        inline std::string_view source() const;
+
+        inline std::size_t size() const;
+        inline bool empty() const;
+        inline Token operator[](std::size_t index) const;
+
+        inline std::span<const TokenKind> kinds() const;
+        inline std::span<const uint32_t> offsets() const;
+        inline std::span<const uint32_t> lengths() const;
+        inline std::span<const uint32_t> payloads() const;
+
+        inline void push_back(const Token& token);
+        void reserve(std::size_t capacity);
+        // attaches the tokens to their file, their offsets are not changed
+        void bind(FileId file);
+        // appends the tokens of other starting at the index from
+        void append(const TokenBuffer& other, std::size_t from = 0);
+        // replaces the tokens [begin, end) by the replacement ones, shifts
+        // the offsets of the following tokens and moves the buffer to the file
+        // of the replacement
+        void splice(std::size_t begin, std::size_t end, const TokenBuffer& replacement, int64_t shift);
+        // removes the count first tokens
+        void erase_front(std::size_t count);
+
+        inline std::string_view raw(const Token& token) const;
+        inline Location location(const Token& token) const;
+
+    private:
+        FileId m_file;
+        std::string_view m_source;
+
+        std::vector<TokenKind> m_kinds;
+        std::vector<uint32_t> m_offsets;
+        std::vector<uint32_t> m_lengths;
+        std::vector<uint32_t> m_payloads;
+    };
+}
+
+#include <frontend/token_buffer.inl>
+
+#endif
@@ -0,0 +1,57 @@
+namespace W {
+    inline FileId TokenBuffer::file() const {
+        return m_file;
+    }
+
+    inline std::string_view TokenBuffer::source() const {
+        return m_source;
+    }
+
+    inline std::size_t TokenBuffer::size() const {
+        return m_kinds.size();
+    }
+
+    inline bool TokenBuffer::empty() const {
+        return m_kinds.empty();
+    }
+
+    inline Token TokenBuffer::operator[](std::size_t index) const {
+        return Token {
+            .offset = m_offsets[index],
+            .length = m_lengths[index],
+            .payload = m_payloads[index],
+            .kind = m_kinds[index],
+        };
+    }
+
+    inline std::span<const TokenKind> TokenBuffer::kinds() const {
+        return m_kinds;
+    }
+
+    inline std::span<const uint32_t> TokenBuffer::offsets() const {
+        return m_offsets;
+    }
+
+    inline std::span<const uint32_t> TokenBuffer::lengths() const {
+        return m_lengths;
+    }
+
+    inline std::span<const uint32_t> TokenBuffer::payloads() const {
+        return m_payloads;
+    }
+
+    inline void TokenBuffer::push_back(const Token& token) {
+        m_kinds.push_back(token.kind);
+        m_offsets.push_back(token.offset);
+        m_lengths.push_back(token.length);
+        m_payloads.push_back(token.payload);
+    }
+
+    inline std::string_view TokenBuffer::raw(const Token& token) const {
+        return token.raw(m_source);
+    }
+
+    inline Location TokenBuffer::location(const Token& token) const {
+        return token.location(m_file);
+    }
+}
@@ -1,15 +1,63 @@
 #ifndef W_TOKEN_STREAM_HPP
 #define W_TOKEN_STREAM_HPP
 
-#include <deque>
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
 
 #include <frontend/ast/nodes.hpp>
 #include <frontend/lexer.hpp>
+#include <frontend/pipelined_lexer.hpp>
+#include <frontend/token_buffer.hpp>
 
 namespace W {
     struct TokenStream {
     public:
-        TokenStream(Lexer& lexer);
+        static constexpr std::size_t s_default_capacity = 256;
+
+        // position the stream can come back to, the tokens after the oldest
+        // alive checkpoint (or after the current token without checkpoint)
+        // are kept, the others are released
+        //
+        // the checkpoints nest: they must be destroyed in the reverse order
+        // of their creation, which the scopes give for free
+        struct Checkpoint {
+        public:
+            Checkpoint(const Checkpoint&) = delete;
+            Checkpoint(Checkpoint&& other) noexcept;
+            ~Checkpoint();
+
+            Checkpoint& operator=(const Checkpoint&) = delete;
+            Checkpoint& operator=(Checkpoint&&) noexcept = delete;
+
+            // moves the stream back to the checkpoint, it can be done several
+            // times
+            void rewind();
+
+        private:
+            friend struct TokenStream;
+
+            Checkpoint(TokenStream& stream, std::size_t position);
+
+            TokenStream* m_stream;
+            std::size_t m_position;
+            std::size_t m_depth;
+        };
+
+        // pulls the tokens from the lexer when they are needed into a ring of
+        // capacity tokens (a power of 2), it only grows if a checkpoint or a
+        // peek spans more tokens
+        TokenStream(Lexer& lexer, std::size_t capacity = s_default_capacity);
+        // same with a lexer running on its own thread
+        TokenStream(PipelinedLexer& lexer, std::size_t capacity = s_default_capacity);
+        // iterates over an already lexed file, the buffer must outlive the
+        // stream
+        TokenStream(const TokenBuffer& tokens);
+        // same over the tokens [begin, end) of the buffer, followed by an Eof
+        // at the offset of the token end
+        TokenStream(const TokenBuffer& tokens, std::size_t begin, std::size_t end);
         TokenStream(const TokenStream&) = delete;
         TokenStream(TokenStream&&) noexcept = default;
         ~TokenStream() = default;
@@ -17,17 +65,115 @@ namespace W {
         TokenStream& operator=(const TokenStream&) = delete;
         TokenStream& operator=(TokenStream&&) noexcept = default;
 
-        const Token& peek(size_t advance = 0);
-        const Token& next();
+        // the Eof token is repeated after the end of the buffer
+        inline Token peek(size_t advance = 0);
+        inline Token next();
+
+        Checkpoint checkpoint();
+
+        // the functions below are only for a stream over a token buffer
+
+        // position of the close token matching an open one already read,
+        // only the kinds of the tokens are scanned; the end of the stream
+        // when it is missing
+        std::size_t matching(TokenKind open, TokenKind close) const;
+        // moves to the position without reading the tokens before it
+        inline void seek(std::size_t position);
+
+        // index of the next token since the start of the file
+        inline std::size_t position() const;
+        // nullptr for a stream pulling from a lexer
+        inline const TokenBuffer* buffer() const;
+        inline FileId file() const;
+        inline std::string_view source() const;
+        inline std::string_view raw(const Token& token) const;
+        inline Location location(const Token& token) const;
+        // size of the ring of a stream pulling from a lexer (pipelined or not)
+        inline std::size_t capacity() const;
 
-        void commit();
-        void uncommit();
-    
     private:
-        std::deque<Token> m_tokens;
-        Lexer& m_lexer;
-        size_t m_index;
+        // pulls from the lexer until the position, called by peek when the
+        // token is not in the ring yet
+        Token pull(std::size_t position);
+        // first position which may still be read
+        inline std::size_t oldest_needed() const;
+        void grow();
+
+        Lexer* m_lexer;
+        PipelinedLexer* m_pipelined;
+        const TokenBuffer* m_external;
+        // the tokens of an external buffer after m_external_end are replaced
+        // by m_external_eof
+        std::size_t m_external_end;
+        Token m_external_eof;
+        FileId m_file;
+        std::string_view m_source;
+
+        // the token at position i is in m_ring[i & (m_ring.size() - 1)]
+        // (unused with an external buffer)
+        std::vector<Token> m_ring;
+        std::size_t m_pulled;
+        std::size_t m_eof;
+
+        std::size_t m_index;
+        // positions of the alive checkpoints, the oldest first
+        std::vector<std::size_t> m_checkpoints;
     };
+
+    inline Token TokenStream::peek(size_t advance) {
+        std::size_t position = m_index + advance;
+        if (m_external != nullptr)
+            return position < m_external_end ? (*m_external)[position] : m_external_eof;
+        if (position < m_pulled)
+            return m_ring[position & (m_ring.size() - 1)];
+
+        return pull(position);
+    }
+
+    inline Token TokenStream::next() {
+        Token token = peek();
+        m_index++;
+        return token;
+    }
+
+    inline std::size_t TokenStream::position() const {
+        return m_index;
+    }
+
+    inline const TokenBuffer* TokenStream::buffer() const {
+        return m_external;
+    }
+
+    inline void TokenStream::seek(std::size_t position) {
+        assert(m_external != nullptr && "only a stream over a token buffer can seek");
+        m_index = std::min(position, m_external_end);
+    }
+
+    inline FileId TokenStream::file() const {
+        return m_file;
+    }
+
+    inline std::string_view TokenStream::source() const {
+        return m_source;
+    }
+
+    inline std::string_view TokenStream::raw(const Token& token) const {
+        return token.raw(m_source);
+    }
+
+    inline Location TokenStream::location(const Token& token) const {
+        return token.location(m_file);
+    }
+
+    inline std::size_t TokenStream::capacity() const {
+        return m_ring.size();
+    }
+
+    inline std::size_t TokenStream::oldest_needed() const {
+        // a stream only goes back to a checkpoint, so the oldest one is
+        // never after the current position
+        return m_checkpoints.empty() ? m_index : m_checkpoints.front();
+    }
 }
 
 #endif
@@ -0,0 +1,69 @@
+#ifndef W_LITERALS_HPP
+#define W_LITERALS_HPP
+
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+#include <utils/stable_vector.hpp>
+
+namespace W {
+    // decoded value of a literal, stored in the payload of the Integer, Float,
+    // String and Rune tokens
+    enum struct LiteralId : uint32_t {
+        // the value does not fit in 64 bits (or in a double)
+        OutOfRange = UINT32_MAX,
+        // a digit, a suffix or an escape which does not belong to the literal
+        Invalid = UINT32_MAX - 1,
+        // a string or a rune without escape, its value is the text of the
+        // token in the source
+        Raw = UINT32_MAX - 2,
+    };
+
+    // process wide table of the decoded literals, the 64-bit values of the
+    // numbers and the strings with escapes; every distinct value is stored
+    // once
+    //
+    // integers under 2^31 (nearly all of them) are kept in the id itself and
+    // never touch the table, the values can be read without any lock
+    struct LiteralTable {
+    public:
+        static LiteralTable& global();
+
+        LiteralTable() = default;
+        LiteralTable(const LiteralTable&) = delete;
+        LiteralTable(LiteralTable&&) noexcept = delete;
+        ~LiteralTable() = default;
+
+        LiteralTable& operator=(const LiteralTable&) = delete;
+        LiteralTable& operator=(LiteralTable&&) noexcept = delete;
+
+        LiteralId intern_integer(uint64_t value);
+        LiteralId intern_float(double value);
+        LiteralId intern_string(std::string_view value);
+
+        inline static bool is_valid(LiteralId literal);
+        inline uint64_t integer(LiteralId literal) const;
+        inline double floating(LiteralId literal) const;
+        // raw is the text of the token, returned for LiteralId::Raw
+        inline std::string_view string(LiteralId literal, std::string_view raw) const;
+
+    private:
+        static constexpr uint32_t s_table_bit = 1u << 31;
+
+        LiteralId intern(uint64_t bits);
+
+        std::mutex m_mutex;
+        std::unordered_map<uint64_t, uint32_t> m_indices;
+        utils::StableVector<uint64_t> m_values;
+        // the elements never move so the keys can view them
+        std::unordered_map<std::string_view, uint32_t> m_string_indices;
+        utils::StableVector<std::string> m_strings;
+    };
+}
+
+#include <literals.inl>
+
+#endif
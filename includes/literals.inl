@@ -0,0 +1,26 @@
+#include <bit>
+
+namespace W {
+    inline bool LiteralTable::is_valid(LiteralId literal) {
+        return literal != LiteralId::OutOfRange && literal != LiteralId::Invalid;
+    }
+
+    inline uint64_t LiteralTable::integer(LiteralId literal) const {
+        uint32_t id = static_cast<uint32_t>(literal);
+        if ((id & s_table_bit) == 0)
+            return id;
+
+        return m_values[id & ~s_table_bit];
+    }
+
+    inline double LiteralTable::floating(LiteralId literal) const {
+        return std::bit_cast<double>(m_values[static_cast<uint32_t>(literal) & ~s_table_bit]);
+    }
+
+    inline std::string_view LiteralTable::string(LiteralId literal, std::string_view raw) const {
+        if (literal == LiteralId::Raw)
+            return raw;
+
+        return m_strings[static_cast<uint32_t>(literal)];
+    }
+}
@@ -1,24 +1,23 @@
 #ifndef LOCATION_H
 #define LOCATION_H
 
-#include <cctype>
-#include <filesystem>
-#include <memory>
+#include <cstdint>
 
 #include <fmt/core.h>
 
+#include <source_manager.hpp>
+
 namespace W {
+    // byte range [begin, end) of a file, see SourceManager to get the lines
+    // and the columns
     struct Location {
         static inline Location merge(const Location& left, const Location& right);
 
         inline void extend_to_right(const Location& other);
 
-        std::shared_ptr<std::filesystem::path> file_path;
-
-        std::size_t start_line;
-        std::size_t start_col;
-        std::size_t end_line;
-        std::size_t end_col;
+        FileId file;
+        uint32_t begin;
+        uint32_t end;
     };
 }
 
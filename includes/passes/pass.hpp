@@ -1,19 +1,23 @@
 #ifndef W_PASS_HPP
 #define W_PASS_HPP
 
-#include <vector>
+#include <span>
 
 #include <frontend/ast/nodes.hpp>
 #include <frontend/ast/expression_type.hpp>
 
 namespace W::Passes {
+    // visitor through the virtual Node::visit, the handle_* helpers visit
+    // the children of a node (see StaticPass for a visitor without virtual
+    // call)
     struct VisitorPass {
-        void handle_statement(std::vector<Ast::StatementPtr>& node);
+        void handle_statement(std::span<Ast::StatementPtr> node);
         void handle_statement(Ast::StatementPtr& node);
-        void handle_expression(std::vector<Ast::ExpressionPtr>& node);
+        void handle_expression(std::span<Ast::ExpressionPtr> node);
         void handle_expression(Ast::ExpressionPtr& node);
 
         void handle_children(Ast::ExpressionType<>& node);
+        void handle_children(Ast::ExpressionType<true>& node);
 
         #define WLANG_AST(node_type, category) \
             void handle_children(Ast::node_type##category& node); \
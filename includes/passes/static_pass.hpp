@@ -0,0 +1,49 @@
+#ifndef W_STATIC_PASS_HPP
+#define W_STATIC_PASS_HPP
+
+#include <span>
+
+#include <frontend/ast/expression_type.hpp>
+#include <frontend/ast/nodes.hpp>
+
+namespace W::Passes {
+    // visitor without virtual call: dispatch switches on the NodeType of the
+    // node and calls the visit of Derived taking it, a kind without visit is
+    // traversed, so a pass only defines the visits it needs
+    //
+    //     struct CountCalls : StaticPass<CountCalls> {
+    //         void visit(Ast::CallExpression& expr) {
+    //             count++;
+    //             traverse(expr);
+    //         }
+    //
+    //         std::size_t count = 0;
+    //     };
+    //
+    // a visit may take Ast::Expression& or Ast::Statement& to see every node
+    // of its category, traverse then switches on the kind
+    template<typename Derived>
+    struct StaticPass {
+    public:
+        // null is ignored
+        inline void dispatch(Ast::Node* node);
+        template<typename T>
+        inline void dispatch(std::span<T*> nodes);
+
+        // dispatches the children of the node in the order of the source
+        #define WLANG_AST(X, C) inline void traverse(Ast::X##C& node);
+        #include <frontend/ast/node_list.hpp>
+        // for the visits of a category, switches on the kind of the node
+        inline void traverse(Ast::Node& node);
+
+    private:
+        template<typename T>
+        inline void visit_node(T& node);
+        template<bool O>
+        inline void dispatch(Ast::ExpressionType<O>& type);
+    };
+}
+
+#include <passes/static_pass.inl>
+
+#endif
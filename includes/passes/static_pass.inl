@@ -0,0 +1,129 @@
+#include <utils/utility.hpp>
+
+namespace W::Passes {
+    template<typename Derived>
+    inline void StaticPass<Derived>::dispatch(Ast::Node* node) {
+        if (node == nullptr)
+            return;
+
+        switch (node->get_type()) {
+            #define WLANG_AST(X, C) case Ast::NodeType::X##C: \
+                return visit_node(static_cast<Ast::X##C&>(*node));
+            #include <frontend/ast/node_list.hpp>
+            default: utils::unreachable();
+        }
+    }
+
+    template<typename Derived>
+    template<typename T>
+    inline void StaticPass<Derived>::dispatch(std::span<T*> nodes) {
+        for (T* node : nodes)
+            dispatch(node);
+    }
+
+    template<typename Derived>
+    template<bool O>
+    inline void StaticPass<Derived>::dispatch(Ast::ExpressionType<O>& type) {
+        if (type.is_expression())
+            dispatch(type.get_expression());
+    }
+
+    template<typename Derived>
+    template<typename T>
+    inline void StaticPass<Derived>::visit_node(T& node) {
+        // the visits of Derived hide each other, a kind without one is not
+        // found and falls back to the traversal
+        Derived& derived = static_cast<Derived&>(*this);
+        if constexpr (requires { derived.visit(node); })
+            derived.visit(node);
+        else
+            traverse(node);
+    }
+
+    template<typename Derived>
+    inline void StaticPass<Derived>::traverse(Ast::Node& node) {
+        switch (node.get_type()) {
+            #define WLANG_AST(X, C) case Ast::NodeType::X##C: \
+                return traverse(static_cast<Ast::X##C&>(node));
+            #include <frontend/ast/node_list.hpp>
+            default: utils::unreachable();
+        }
+    }
+
+    template<typename Derived>
+    inline void StaticPass<Derived>::traverse(Ast::AccessIdentifierExpression& expr) {
+        dispatch(expr.members);
+    }
+
+    template<typename Derived>
+    inline void StaticPass<Derived>::traverse(Ast::CallExpression& expr) {
+        dispatch(expr.callee);
+        dispatch(expr.params);
+    }
+
+    template<typename Derived>
+    inline void StaticPass<Derived>::traverse(Ast::BinaryExpression& expr) {
+        dispatch(expr.left);
+        dispatch(expr.right);
+    }
+
+    template<typename Derived>
+    inline void StaticPass<Derived>::traverse(Ast::UnaryExpression& expr) {
+        dispatch(expr.expr);
+    }
+
+    template<typename Derived>
+    inline void StaticPass<Derived>::traverse(Ast::IdentExpression&) {}
+
+    template<typename Derived>
+    inline void StaticPass<Derived>::traverse(Ast::ParentExpression& expr) {
+        dispatch(expr.expr);
+    }
+
+    template<typename Derived>
+    inline void StaticPass<Derived>::traverse(Ast::ArrayTypeExpression& expr) {
+        dispatch(expr.lenght);
+        dispatch(expr.inner_type);
+    }
+
+    template<typename Derived>
+    inline void StaticPass<Derived>::traverse(Ast::SliceTypeExpression& expr) {
+        dispatch(expr.inner_type);
+    }
+
+    template<typename Derived>
+    inline void StaticPass<Derived>::traverse(Ast::BoolLiteral&) {}
+
+    template<typename Derived>
+    inline void StaticPass<Derived>::traverse(Ast::IntLiteral&) {}
+
+    template<typename Derived>
+    inline void StaticPass<Derived>::traverse(Ast::FloatLiteral&) {}
+
+    template<typename Derived>
+    inline void StaticPass<Derived>::traverse(Ast::EnumVariantLiteral&) {}
+
+    template<typename Derived>
+    inline void StaticPass<Derived>::traverse(Ast::RuneLiteral&) {}
+
+    template<typename Derived>
+    inline void StaticPass<Derived>::traverse(Ast::StringLiteral&) {}
+
+    template<typename Derived>
+    inline void StaticPass<Derived>::traverse(Ast::ExpressionStatement& stmt) {
+        dispatch(stmt.expr);
+    }
+
+    template<typename Derived>
+    inline void StaticPass<Derived>::traverse(Ast::DeclareFunctionStatement& stmt) {
+        for (Ast::DeclareFunctionStatement::Parameter& parameter : stmt.parameters)
+            dispatch(parameter.type);
+        dispatch(stmt.return_type);
+        dispatch(stmt.body);
+    }
+
+    template<typename Derived>
+    inline void StaticPass<Derived>::traverse(Ast::DeclareVariableStatement& stmt) {
+        dispatch(stmt.value);
+    }
+}
@@ -0,0 +1,95 @@
+#ifndef W_SOURCE_MANAGER_HPP
+#define W_SOURCE_MANAGER_HPP
+
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string_view>
+#include <vector>
+
+#include <frontend/source_buffer.hpp>
+#include <utils/stable_vector.hpp>
+
+namespace W {
+    enum struct FileId : uint32_t {};
+
+    struct LineColumn {
+        // both start at 1, the column is counted in bytes
+        uint32_t line;
+        uint32_t column;
+    };
+
+    struct SourceFile {
+    public:
+        SourceFile(std::filesystem::path path, SourceBuffer buffer);
+        SourceFile(const SourceFile&) = delete;
+        SourceFile(SourceFile&&) noexcept = delete;
+        ~SourceFile() = default;
+
+        SourceFile& operator=(const SourceFile&) = delete;
+        SourceFile& operator=(SourceFile&&) noexcept = delete;
+
+        inline const std::filesystem::path& path() const;
+        // views the current version, an edit of the file invalidates it
+        inline std::string_view content() const;
+        // keeps the current version alive and unchanged, the file is copied
+        // by the next edit while a snapshot is held, otherwise it is edited
+        // in place
+        inline std::shared_ptr<const SourceBuffer> snapshot() const;
+        // offset of the first invalid UTF-8 sequence, checked when the file is
+        // registered and around every edit
+        inline std::optional<uint32_t> invalid_utf8() const;
+
+        // offset of the first byte of every line, built on the first call
+        // after the file is registered or edited
+        const std::vector<uint32_t>& line_starts() const;
+        LineColumn line_column(uint32_t offset) const;
+
+    private:
+        friend struct SourceManager;
+
+        void edit(const TextEdit& edit);
+        void revalidate_utf8(const TextEdit& edit);
+
+        std::filesystem::path m_path;
+        std::shared_ptr<SourceBuffer> m_buffer;
+        std::optional<uint32_t> m_invalid_utf8;
+
+        mutable std::mutex m_line_starts_mutex;
+        mutable std::vector<uint32_t> m_line_starts;
+    };
+
+    // owns every source file of the process, a file is registered once and
+    // then referenced by its FileId, so locations only carry 32-bit integers
+    // and lines/columns are resolved when a diagnostic is printed
+    struct SourceManager {
+    public:
+        static SourceManager& global();
+
+        SourceManager() = default;
+        SourceManager(const SourceManager&) = delete;
+        SourceManager(SourceManager&&) noexcept = delete;
+        ~SourceManager() = default;
+
+        SourceManager& operator=(const SourceManager&) = delete;
+        SourceManager& operator=(SourceManager&&) noexcept = delete;
+
+        FileId add(std::filesystem::path path, SourceBuffer buffer);
+        // applies the edit to file which keeps its FileId, the previous
+        // version is only kept by the snapshots still holding it; nothing may
+        // read the file while it is edited and its TokenBuffers are brought
+        // up to date with Lexer::relex
+        void edit(FileId file, const TextEdit& edit);
+        inline const SourceFile& file(FileId id) const;
+
+    private:
+        std::mutex m_mutex;
+        utils::StableVector<std::unique_ptr<SourceFile>> m_files;
+    };
+}
+
+#include <source_manager.inl>
+
+#endif
@@ -0,0 +1,21 @@
+namespace W {
+    inline const std::filesystem::path& SourceFile::path() const {
+        return m_path;
+    }
+
+    inline std::string_view SourceFile::content() const {
+        return m_buffer->view();
+    }
+
+    inline std::shared_ptr<const SourceBuffer> SourceFile::snapshot() const {
+        return m_buffer;
+    }
+
+    inline std::optional<uint32_t> SourceFile::invalid_utf8() const {
+        return m_invalid_utf8;
+    }
+
+    inline const SourceFile& SourceManager::file(FileId id) const {
+        return *m_files[static_cast<uint32_t>(id)];
+    }
+}
@@ -0,0 +1,76 @@
+#ifndef W_SYMBOLS_HPP
+#define W_SYMBOLS_HPP
+
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string_view>
+#include <vector>
+
+#include <fmt/core.h>
+
+#include <utils/stable_vector.hpp>
+
+namespace W {
+    // interned name, two identical names always have the same id so comparing
+    // symbols is an integer comparison
+    enum struct SymbolId : uint32_t {};
+
+    // process wide string table, every distinct name is stored once in an
+    // arena and indexed by a hash table
+    //
+    // the table is split in shards, each with its own lock, so lexers running
+    // on different threads rarely wait for each other; the low bits of an id
+    // are its shard and the name of an id can be read without any lock
+    struct SymbolTable {
+    public:
+        static SymbolTable& global();
+
+        SymbolTable() = default;
+        SymbolTable(const SymbolTable&) = delete;
+        SymbolTable(SymbolTable&&) noexcept = delete;
+        ~SymbolTable() = default;
+
+        SymbolTable& operator=(const SymbolTable&) = delete;
+        SymbolTable& operator=(SymbolTable&&) noexcept = delete;
+
+        SymbolId intern(std::string_view name);
+        inline std::string_view name(SymbolId symbol) const;
+
+    private:
+        static constexpr std::size_t s_shard_bits = 4;
+        static constexpr std::size_t s_arena_chunk_size = 64 * 1024;
+
+        struct Slot {
+            uint32_t hash;
+            // index + 1 of the name in the shard, 0 for an empty slot
+            uint32_t index;
+        };
+
+        struct Shard {
+            std::string_view store(std::string_view name);
+            void grow();
+
+            std::mutex mutex;
+            utils::StableVector<std::string_view> names;
+            std::vector<Slot> slots;
+            std::vector<std::unique_ptr<char[]>> chunks;
+            char* chunk_cursor = nullptr;
+            std::size_t chunk_remaining = 0;
+        };
+
+        std::array<Shard, 1 << s_shard_bits> m_shards;
+    };
+}
+
+template <> struct fmt::formatter<W::SymbolId>: formatter<std::string_view> {
+  // parse is inherited from formatter<std::string_view>.
+
+  auto format(W::SymbolId symbol, format_context& ctx) const
+    -> format_context::iterator;
+};
+
+#include <symbols.inl>
+
+#endif
@@ -0,0 +1,8 @@
+namespace W {
+    inline std::string_view SymbolTable::name(SymbolId symbol) const {
+        uint32_t id = static_cast<uint32_t>(symbol);
+        const Shard& shard = m_shards[id & ((1 << s_shard_bits) - 1)];
+
+        return shard.names[id >> s_shard_bits];
+    }
+}
@@ -0,0 +1,63 @@
+#ifndef W_ARENA_HPP
+#define W_ARENA_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string_view>
+
+namespace W::utils {
+    // bump allocator owning objects which are freed all at once, with the
+    // arena: the destructors are never called so only trivially destructible
+    // types are accepted
+    //
+    // the memory is a list of chunks of growing size (16KB, 32KB, ... up to
+    // 1MB), an allocation bigger than a quarter of a chunk gets its own chunk
+    struct Arena {
+    public:
+        Arena() = default;
+        Arena(const Arena&) = delete;
+        Arena(Arena&& other) noexcept;
+        ~Arena();
+
+        Arena& operator=(const Arena&) = delete;
+        Arena& operator=(Arena&& other) noexcept;
+
+        inline void* allocate(std::size_t size, std::size_t align);
+
+        template<typename T, typename... Args>
+        inline T* make(Args&&... args);
+        // moves the elements into the arena
+        template<typename T>
+        inline std::span<T> make_span(std::span<T> elements);
+        inline std::string_view make_string(std::string_view string);
+
+        // takes the chunks of other, which is left empty, the objects it
+        // allocated are now owned by this arena
+        void adopt(Arena&& other);
+
+        // bytes reserved from the system
+        inline std::size_t capacity() const;
+
+    private:
+        static constexpr std::size_t s_min_chunk_size = 16 * 1024;
+        static constexpr std::size_t s_max_chunk_size = 1024 * 1024;
+
+        struct Chunk {
+            Chunk* previous;
+            std::size_t size;
+        };
+
+        void* allocate_slow(std::size_t size, std::size_t align);
+        void release();
+
+        Chunk* m_chunk = nullptr;
+        uintptr_t m_cursor = 0;
+        uintptr_t m_end = 0;
+        std::size_t m_capacity = 0;
+    };
+}
+
+#include <utils/arena.inl>
+
+#endif
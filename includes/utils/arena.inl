@@ -0,0 +1,49 @@
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace W::utils {
+    inline void* Arena::allocate(std::size_t size, std::size_t align) {
+        uintptr_t begin = (m_cursor + align - 1) & ~(align - 1);
+        if (begin + size > m_end) [[unlikely]]
+            return allocate_slow(size, align);
+
+        m_cursor = begin + size;
+        return reinterpret_cast<void*>(begin);
+    }
+
+    template<typename T, typename... Args>
+    inline T* Arena::make(Args&&... args) {
+        static_assert(std::is_trivially_destructible_v<T>, "the arena never calls the destructors");
+
+        return new (allocate(sizeof(T), alignof(T))) T(std::forward<Args>(args)...);
+    }
+
+    template<typename T>
+    inline std::span<T> Arena::make_span(std::span<T> elements) {
+        static_assert(std::is_trivially_destructible_v<T>, "the arena never calls the destructors");
+
+        if (elements.empty())
+            return std::span<T>();
+
+        T* stored = static_cast<T*>(allocate(sizeof(T) * elements.size(), alignof(T)));
+        for (std::size_t i = 0; i < elements.size(); i++)
+            new (stored + i) T(std::move(elements[i]));
+
+        return std::span<T>(stored, elements.size());
+    }
+
+    inline std::string_view Arena::make_string(std::string_view string) {
+        if (string.empty())
+            return std::string_view();
+
+        char* stored = static_cast<char*>(allocate(string.size(), 1));
+        std::char_traits<char>::copy(stored, string.data(), string.size());
+
+        return std::string_view(stored, string.size());
+    }
+
+    inline std::size_t Arena::capacity() const {
+        return m_capacity;
+    }
+}
@@ -0,0 +1,57 @@
+#ifndef W_SPSC_RING_HPP
+#define W_SPSC_RING_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+
+namespace W::utils {
+    // lock-free ring of Capacity slots shared by exactly one producer thread
+    // and one consumer thread, the slots are filled and read in place so big
+    // elements (i.e. batches) are never copied
+    //
+    // the slots live on the heap and are left uninitialized, the producer
+    // writes a slot before publishing it
+    //
+    // a side waits for the other by spinning a little then sleeping on the
+    // opposite index with std::atomic::wait
+    template<typename T, std::size_t Capacity>
+    struct SpscRing {
+    public:
+        static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0, "the capacity must be a power of 2");
+
+        SpscRing() = default;
+        SpscRing(const SpscRing&) = delete;
+        SpscRing(SpscRing&&) = delete;
+        ~SpscRing() = default;
+
+        SpscRing& operator=(const SpscRing&) = delete;
+        SpscRing& operator=(SpscRing&&) = delete;
+
+        // producer side: waits for a free slot, fills it then publishes it
+        inline T& wait_free_slot();
+        inline void publish();
+
+        // consumer side: waits for a published slot, reads it then gives it
+        // back to the producer
+        inline T& wait_published_slot();
+        inline void release();
+
+    private:
+        static constexpr std::size_t s_spins = 256;
+
+        static inline void wait_change(const std::atomic<std::size_t>& index, std::size_t old);
+
+        std::unique_ptr<T[]> m_slots = std::make_unique_for_overwrite<T[]>(Capacity);
+
+        // one cache line per index so both sides do not bounce it
+        alignas(64) std::atomic<std::size_t> m_head = 0;
+        std::size_t m_cached_tail = 0;
+        alignas(64) std::atomic<std::size_t> m_tail = 0;
+        std::size_t m_cached_head = 0;
+    };
+}
+
+#include <utils/spsc_ring.inl>
+
+#endif
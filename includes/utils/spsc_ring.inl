@@ -0,0 +1,48 @@
+#include <thread>
+
+namespace W::utils {
+    template<typename T, std::size_t Capacity>
+    inline void SpscRing<T, Capacity>::wait_change(const std::atomic<std::size_t>& index, std::size_t old) {
+        for (std::size_t i = 0; i < s_spins; i++) {
+            if (index.load(std::memory_order_acquire) != old)
+                return;
+            std::this_thread::yield();
+        }
+        index.wait(old, std::memory_order_acquire);
+    }
+
+    template<typename T, std::size_t Capacity>
+    inline T& SpscRing<T, Capacity>::wait_free_slot() {
+        std::size_t head = m_head.load(std::memory_order_relaxed);
+        // the tail is only read again when the ring looks full
+        while (head - m_cached_tail == Capacity) {
+            wait_change(m_tail, m_cached_tail);
+            m_cached_tail = m_tail.load(std::memory_order_acquire);
+        }
+
+        return m_slots[head & (Capacity - 1)];
+    }
+
+    template<typename T, std::size_t Capacity>
+    inline void SpscRing<T, Capacity>::publish() {
+        m_head.store(m_head.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+        m_head.notify_one();
+    }
+
+    template<typename T, std::size_t Capacity>
+    inline T& SpscRing<T, Capacity>::wait_published_slot() {
+        std::size_t tail = m_tail.load(std::memory_order_relaxed);
+        while (tail == m_cached_head) {
+            wait_change(m_head, m_cached_head);
+            m_cached_head = m_head.load(std::memory_order_acquire);
+        }
+
+        return m_slots[tail & (Capacity - 1)];
+    }
+
+    template<typename T, std::size_t Capacity>
+    inline void SpscRing<T, Capacity>::release() {
+        m_tail.store(m_tail.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+        m_tail.notify_one();
+    }
+}
@@ -0,0 +1,51 @@
+#ifndef W_STABLE_VECTOR_HPP
+#define W_STABLE_VECTOR_HPP
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace W::utils {
+    // append-only vector whose elements never move, the storage is a list of
+    // segments of growing size (64, 128, 256, ...) so an index maps to its
+    // segment with a single bit scan
+    //
+    // there must be only one writer at a time, but readers may access any
+    // index lower than a size() they observed without synchronisation
+    template<typename T>
+    struct StableVector {
+    public:
+        StableVector() = default;
+        StableVector(const StableVector&) = delete;
+        StableVector(StableVector&& other) noexcept;
+        ~StableVector();
+
+        StableVector& operator=(const StableVector&) = delete;
+        StableVector& operator=(StableVector&& other) noexcept;
+
+        inline std::size_t size() const;
+        inline bool empty() const;
+
+        inline const T& operator[](std::size_t index) const;
+        inline T& operator[](std::size_t index);
+
+        // returns the index of the new element
+        std::size_t push_back(T value);
+        void clear();
+
+    private:
+        static constexpr std::size_t s_base_bits = 6;
+        static constexpr std::size_t s_segment_count = 64 - s_base_bits;
+
+        static inline std::size_t segment_of(std::size_t index);
+        static inline std::size_t segment_begin(std::size_t segment);
+
+        std::array<std::atomic<T*>, s_segment_count> m_segments {};
+        std::atomic<std::size_t> m_size = 0;
+    };
+}
+
+#include <utils/stable_vector.inl>
+
+#endif
@@ -0,0 +1,82 @@
+#include <bit>
+#include <utility>
+
+namespace W::utils {
+    template<typename T>
+    StableVector<T>::StableVector(StableVector&& other) noexcept {
+        *this = std::move(other);
+    }
+
+    template<typename T>
+    StableVector<T>::~StableVector() {
+        clear();
+    }
+
+    template<typename T>
+    StableVector<T>& StableVector<T>::operator=(StableVector&& other) noexcept {
+        if (this != &other) {
+            clear();
+            for (std::size_t i = 0; i < s_segment_count; i++)
+                m_segments[i].store(other.m_segments[i].exchange(nullptr, std::memory_order_relaxed), std::memory_order_relaxed);
+            m_size.store(other.m_size.exchange(0, std::memory_order_relaxed), std::memory_order_release);
+        }
+        return *this;
+    }
+
+    template<typename T>
+    inline std::size_t StableVector<T>::segment_of(std::size_t index) {
+        // segment k holds the indexes [2^(k+b) - 2^b, 2^(k+b+1) - 2^b)
+        return std::bit_width((index >> s_base_bits) + 1) - 1;
+    }
+
+    template<typename T>
+    inline std::size_t StableVector<T>::segment_begin(std::size_t segment) {
+        return ((std::size_t(1) << segment) - 1) << s_base_bits;
+    }
+
+    template<typename T>
+    inline std::size_t StableVector<T>::size() const {
+        return m_size.load(std::memory_order_acquire);
+    }
+
+    template<typename T>
+    inline bool StableVector<T>::empty() const {
+        return size() == 0;
+    }
+
+    template<typename T>
+    inline const T& StableVector<T>::operator[](std::size_t index) const {
+        std::size_t segment = segment_of(index);
+        return m_segments[segment].load(std::memory_order_acquire)[index - segment_begin(segment)];
+    }
+
+    template<typename T>
+    inline T& StableVector<T>::operator[](std::size_t index) {
+        std::size_t segment = segment_of(index);
+        return m_segments[segment].load(std::memory_order_acquire)[index - segment_begin(segment)];
+    }
+
+    template<typename T>
+    std::size_t StableVector<T>::push_back(T value) {
+        std::size_t index = m_size.load(std::memory_order_relaxed);
+        std::size_t segment = segment_of(index);
+
+        T* data = m_segments[segment].load(std::memory_order_relaxed);
+        if (data == nullptr) {
+            data = new T[std::size_t(1) << (segment + s_base_bits)];
+            m_segments[segment].store(data, std::memory_order_release);
+        }
+
+        data[index - segment_begin(segment)] = std::move(value);
+        m_size.store(index + 1, std::memory_order_release);
+
+        return index;
+    }
+
+    template<typename T>
+    void StableVector<T>::clear() {
+        for (auto& segment : m_segments)
+            delete[] segment.exchange(nullptr, std::memory_order_relaxed);
+        m_size.store(0, std::memory_order_release);
+    }
+}
@@ -0,0 +1,86 @@
+#ifndef W_THREAD_POOL_HPP
+#define W_THREAD_POOL_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace W::utils {
+    // fixed set of threads running tasks, every worker has its own deque: it
+    // pushes and pops its tasks at the back and, once empty, takes the
+    // oldest task submitted from outside the pool, then steals from the
+    // front of the other deques; the tasks spawned by a task stay on its
+    // thread while the outside tasks run in the order they were submitted
+    struct ThreadPool {
+    public:
+        using Task = std::function<void()>;
+
+        // 0 uses every hardware thread
+        ThreadPool(unsigned threads = 0);
+        // the workers point to the pool, it cannot move
+        ThreadPool(const ThreadPool&) = delete;
+        ThreadPool(ThreadPool&&) noexcept = delete;
+        // runs the tasks left then stops the threads
+        ~ThreadPool();
+
+        ThreadPool& operator=(const ThreadPool&) = delete;
+        ThreadPool& operator=(ThreadPool&&) noexcept = delete;
+
+        // a task submitted by a task of the pool goes to the deque of its
+        // worker, the others to a queue shared by the workers
+        void submit(Task task);
+        // blocks until every task (including the ones submitted meanwhile)
+        // has run, then rethrows the first exception thrown by a task; it
+        // must not be called by a task
+        void wait();
+        // runs `task(0)` to `task(count - 1)` on the pool and blocks until
+        // they have all returned, then rethrows the first exception thrown by
+        // one of them; unlike wait it only waits for its own tasks, and a task
+        // of the pool calling it runs tasks meanwhile instead of blocking its
+        // worker
+        void run_all(std::size_t count, const std::function<void(std::size_t)>& task);
+
+        inline std::size_t size() const;
+
+    private:
+        struct Worker {
+            std::mutex mutex;
+            std::deque<Task> tasks;
+        };
+
+        void run(std::size_t index);
+        // the back of its own deque first, then the front of the shared
+        // queue and of the other deques
+        bool pop(std::size_t index, Task& task);
+        void execute(Task& task);
+        void finish(std::exception_ptr error);
+
+        std::vector<std::unique_ptr<Worker>> m_workers;
+        std::vector<std::thread> m_threads;
+        // the tasks submitted from outside the pool, first in first out
+        Worker m_injected;
+
+        // tasks in the deques, read without the lock by the workers looking
+        // for work
+        std::atomic<std::size_t> m_queued;
+
+        std::mutex m_mutex;
+        std::condition_variable m_wake;
+        std::condition_variable m_idle;
+        // tasks submitted and not finished yet
+        std::size_t m_pending;
+        bool m_stop;
+        std::exception_ptr m_error;
+    };
+}
+
+#include <utils/thread_pool.inl>
+
+#endif
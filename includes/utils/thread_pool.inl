@@ -0,0 +1,5 @@
+namespace W::utils {
+    inline std::size_t ThreadPool::size() const {
+        return m_threads.size();
+    }
+}
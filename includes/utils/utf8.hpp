@@ -0,0 +1,16 @@
+#ifndef W_UTF8_HPP
+#define W_UTF8_HPP
+
+#include <cstddef>
+#include <string_view>
+
+namespace W::utils {
+    // decodes the code point at the start of text, returns the number of
+    // bytes it uses or 0 if the sequence is invalid (truncated, overlong,
+    // surrogate or over U+10FFFF)
+    inline std::size_t decode_utf8(std::string_view text, char32_t& code_point);
+}
+
+#include <utils/utf8.inl>
+
+#endif
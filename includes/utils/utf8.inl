@@ -0,0 +1,38 @@
+#include <array>
+#include <cstdint>
+
+namespace W::utils {
+    inline std::size_t decode_utf8(std::string_view text, char32_t& code_point) {
+        // length of a sequence from the 5 high bits of its first byte, 0 for a
+        // continuation byte or a byte which never starts a sequence
+        static constexpr std::array<uint8_t, 32> lengths = {
+            1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,
+            0, 0, 0, 0, 0, 0, 0, 0, 2, 2, 2, 2, 3, 3, 4, 0,
+        };
+        // payload bits of the first byte and smallest value by length
+        static constexpr std::array<uint8_t, 5> masks = { 0, 0x7f, 0x1f, 0x0f, 0x07 };
+        static constexpr std::array<uint32_t, 5> minimums = { 0, 0, 0x80, 0x800, 0x10000 };
+
+        if (text.empty())
+            return 0;
+
+        unsigned char lead = static_cast<unsigned char>(text[0]);
+        std::size_t length = lengths[lead >> 3];
+        if (length == 0 || text.size() < length)
+            return 0;
+
+        uint32_t value = lead & masks[length];
+        for (std::size_t i = 1; i < length; i++) {
+            unsigned char c = static_cast<unsigned char>(text[i]);
+            if ((c & 0xc0) != 0x80)
+                return 0;
+            value = value << 6 | (c & 0x3f);
+        }
+
+        if (value < minimums[length] || value > 0x10ffff || (value >= 0xd800 && value <= 0xdfff))
+            return 0;
+
+        code_point = value;
+        return length;
+    }
+}
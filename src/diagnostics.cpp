@@ -0,0 +1,25 @@
+#include <algorithm>
+
+#include <diagnostics.hpp>
+
+namespace W {
+    void Diagnostics::append(const Diagnostics& other) {
+        append(other.all());
+    }
+
+    void Diagnostics::append(std::span<const Diagnostic> diagnostics) {
+        m_diagnostics.reserve(m_diagnostics.size() + diagnostics.size());
+        for (Diagnostic diagnostic : diagnostics) {
+            diagnostic.message = m_arena.make_string(diagnostic.message);
+            m_diagnostics.push_back(diagnostic);
+        }
+    }
+
+    void Diagnostics::sort() {
+        std::stable_sort(m_diagnostics.begin(), m_diagnostics.end(), [](const Diagnostic& left, const Diagnostic& right) {
+            if (left.location.file != right.location.file)
+                return left.location.file < right.location.file;
+            return left.location.begin < right.location.begin;
+        });
+    }
+}
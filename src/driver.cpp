@@ -0,0 +1,146 @@
+#include <algorithm>
+#include <exception>
+#include <optional>
+#include <thread>
+
+#include <unistd.h>
+
+#include <driver.hpp>
+#include <frontend/ast/ast_cache.hpp>
+#include <frontend/ast/flat_tree.hpp>
+#include <frontend/lexer.hpp>
+#include <frontend/parallel_lexer.hpp>
+#include <frontend/parallel_parser.hpp>
+#include <frontend/parser.hpp>
+#include <frontend/pipelined_lexer.hpp>
+#include <frontend/stream_reader.hpp>
+#include <frontend/token_stream.hpp>
+#include <utils/arena.hpp>
+#include <utils/thread_pool.hpp>
+
+namespace W {
+    Driver::Driver(Options options):
+        m_options(options),
+        m_statements(0),
+        m_cached(0)
+    {}
+
+    void Driver::add(const std::filesystem::path& path) {
+        std::error_code error;
+        if (!std::filesystem::is_directory(path, error)) {
+            // a missing file is reported by run
+            m_paths.push_back(path);
+            return;
+        }
+
+        for (const auto& entry : std::filesystem::recursive_directory_iterator(path)) {
+            if (entry.is_regular_file() && entry.path().extension() == ".w")
+                m_paths.push_back(entry.path());
+        }
+    }
+
+    bool Driver::run() {
+        std::sort(m_paths.begin(), m_paths.end());
+        m_paths.erase(std::unique(m_paths.begin(), m_paths.end()), m_paths.end());
+
+        std::vector<Unit> units(m_paths.size());
+        for (std::size_t i = 0; i < units.size(); i++)
+            units[i].path = m_paths[i];
+
+        unsigned jobs = m_options.jobs != 0 ? m_options.jobs : std::max(std::thread::hardware_concurrency(), 1u);
+        if (units.size() == 1) {
+            process(units[0], jobs);
+        } else if (!units.empty()) {
+            // the biggest files first, a big file taken last would keep a
+            // single thread busy at the end
+            std::vector<std::pair<uintmax_t, Unit*>> order;
+            order.reserve(units.size());
+            for (Unit& unit : units) {
+                std::error_code error;
+                uintmax_t size = std::filesystem::file_size(unit.path, error);
+                order.emplace_back(error ? 0 : size, &unit);
+            }
+            std::stable_sort(order.begin(), order.end(), [](const auto& left, const auto& right) {
+                return left.first > right.first;
+            });
+
+            utils::ThreadPool pool(static_cast<unsigned>(std::min<std::size_t>(jobs, units.size())));
+            for (auto& [size, unit] : order)
+                pool.submit([this, unit] { process(*unit, 1); });
+            pool.wait();
+        }
+
+        for (Unit& unit : units) {
+            m_statements += unit.statements;
+            m_cached += unit.cached;
+            m_diagnostics.append(unit.diagnostics);
+            if (!unit.failure.empty())
+                m_failures.push_back(Failure { unit.path, std::move(unit.failure) });
+        }
+
+        return m_diagnostics.empty() && m_failures.empty();
+    }
+
+    void Driver::process(Unit& unit, unsigned threads) const {
+        try {
+            // the AST is not used after the parsing yet
+            utils::Arena arena;
+            // the chunks of the lexer and the parser share the threads of
+            // the file, it is made only when the file may be split
+            std::optional<utils::ThreadPool> pool;
+
+            if (unit.path == "-") {
+                // usually a pipe, which cannot be mapped
+                StreamReader reader(STDIN_FILENO);
+                TokenBuffer tokens = Lexer::lex_stream("<stdin>", reader);
+                if (threads > 1 && tokens.size() >= ParallelParser::Options().threshold)
+                    pool.emplace(threads);
+                unit.statements = ParallelParser(tokens, ParallelParser::Options { .threads = 1, .pool = pool ? &*pool : nullptr }).parse_all(arena, unit.diagnostics).size();
+            } else {
+                FileId file = SourceManager::global().add(unit.path, SourceBuffer::map_file(unit.path));
+                std::size_t size = SourceManager::global().file(file).content().size();
+
+                std::optional<Ast::AstCache> cache;
+                if (!m_options.cache.empty()) {
+                    cache.emplace(m_options.cache);
+                    if (std::optional<Ast::FlatTree> tree = cache->load(file)) {
+                        unit.statements = tree->roots().size();
+                        unit.cached = true;
+                        return;
+                    }
+                }
+
+                std::vector<Ast::StatementPtr> statements;
+                if (threads > 1 && size < ParallelLexer::Options().threshold) {
+                    // too small to be split, the lexer runs ahead of the
+                    // parser on another core instead
+                    PipelinedLexer lexer(file);
+                    TokenStream token_stream(lexer);
+                    Parser parser(token_stream, arena, unit.diagnostics);
+                    while (token_stream.peek().kind != TokenKind::Eof) {
+                        if (Ast::StatementPtr statement = parser.next())
+                            statements.push_back(statement);
+                    }
+                } else {
+                    if (threads > 1)
+                        pool.emplace(threads);
+                    // without a pool (a single job) nothing is split
+                    utils::ThreadPool* shared = pool ? &*pool : nullptr;
+                    TokenBuffer tokens = ParallelLexer(file, ParallelLexer::Options { .threads = 1, .pool = shared }).lex_all();
+                    statements = ParallelParser(tokens, ParallelParser::Options { .threads = 1, .pool = shared }).parse_all(arena, unit.diagnostics);
+                }
+                unit.statements = statements.size();
+
+                // a file with errors is parsed again for its diagnostics
+                if (cache && unit.diagnostics.empty())
+                    cache->store(Ast::FlatTree::build(file, statements));
+            }
+
+            unit.diagnostics.sort();
+        } catch (std::exception& e) {
+            // a file which cannot be read or is too big is reported alone,
+            // the other files are still processed
+            unit.failure = e.what();
+        }
+    }
+}
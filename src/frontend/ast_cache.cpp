@@ -0,0 +1,383 @@
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <random>
+#include <string>
+#include <system_error>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+#include <symbols.hpp>
+#include <frontend/ast/ast_cache.hpp>
+#include <frontend/source_buffer.hpp>
+
+namespace W::Ast {
+    namespace {
+        struct Header {
+            char magic[4];
+            uint32_t sections;
+            // the version and the size of every array element, a tree stored
+            // by another build is never read
+            uint64_t layout;
+            uint64_t source_hash;
+            uint64_t source_size;
+        };
+
+        // bytes [offset, offset + size) of the file
+        struct Section {
+            uint64_t offset;
+            uint64_t size;
+        };
+
+        constexpr char s_magic[4] = { 'W', 'A', 'S', 'T' };
+        constexpr std::size_t s_alignment = 8;
+
+        // the symbols of a node, they are the only fields relocated
+        template<typename F> void symbols(Flat::IdentExpression& node, F&& f) { f(node.value); }
+        template<typename F> void symbols(Flat::EnumVariantLiteral& node, F&& f) { f(node.value); }
+        template<typename F> void symbols(Flat::Parameter& node, F&& f) { f(node.name); }
+        template<typename F> void symbols(Flat::DeclareFunctionStatement& node, F&& f) { f(node.name); }
+        template<typename F> void symbols(Flat::DeclareVariableStatement& node, F&& f) { f(node.name); }
+
+        template<typename T>
+        concept HasSymbols = requires(T& node) { symbols(node, [](SymbolId&) {}); };
+
+        template<typename Array>
+        using Element = typename std::remove_cvref_t<Array>::value_type;
+
+        // the links of a node to the rest of the tree, checked by the load
+        // through l.node(handle, optional), l.list(range, may_be_empty),
+        // l.parameters(range) and l.string(range); the recovery of the
+        // locations walks the handles which are not optional
+        template<typename T, typename L> bool links(const T&, L&) { return true; }
+        template<typename L> bool links(const Flat::AccessIdentifierExpression& node, L& l) { return l.list(node.members, false); }
+        template<typename L> bool links(const Flat::CallExpression& node, L& l) { return l.node(node.callee, false) && l.list(node.params, true); }
+        template<typename L> bool links(const Flat::BinaryExpression& node, L& l) { return l.node(node.left, false) && l.node(node.right, false); }
+        template<typename L> bool links(const Flat::UnaryExpression& node, L& l) { return l.node(node.expr, false); }
+        template<typename L> bool links(const Flat::ParentExpression& node, L& l) { return l.node(node.expr, false); }
+        template<typename L> bool links(const Flat::ArrayTypeExpression& node, L& l) { return l.node(node.lenght, true) && l.node(node.inner_type, false); }
+        template<typename L> bool links(const Flat::SliceTypeExpression& node, L& l) { return l.node(node.inner_type, false); }
+        template<typename L> bool links(const Flat::StringLiteral& node, L& l) { return l.string(node.value); }
+        template<typename L> bool links(const Flat::ExpressionStatement& node, L& l) { return l.node(node.expr, false); }
+        template<typename L> bool links(const Flat::DeclareFunctionStatement& node, L& l) {
+            return l.node(node.return_type, true) && l.parameters(node.parameters) && l.list(node.body, true);
+        }
+        template<typename L> bool links(const Flat::DeclareVariableStatement& node, L& l) { return l.node(node.value, true); }
+
+        bool contains(FlatRange range, std::size_t size) {
+            return range.begin <= size && range.size <= size - range.begin;
+        }
+
+        // the stored locations of an array of nodes are offsets in the source
+        template<typename Array>
+        bool locations_valid(const Array& array, std::size_t source_size) {
+            using T = Element<decltype(array.nodes)>;
+            if constexpr (T::s_location == LocationStorage::None) {
+                return array.locations.empty();
+            } else {
+                if (array.locations.size() != array.nodes.size())
+                    return false;
+                for (const auto& location : array.locations) {
+                    if constexpr (T::s_location == LocationStorage::Span) {
+                        if (location.begin > location.end || location.end > source_size)
+                            return false;
+                    } else if (location > source_size) {
+                        return false;
+                    }
+                }
+                return true;
+            }
+        }
+    }
+
+    template<typename Tree, typename F>
+    void AstCache::for_each_array(Tree& tree, F&& f) {
+        f(tree.m_roots);
+        f(tree.m_children);
+        f(tree.m_parameters);
+        f(tree.m_parameter_locations);
+        f(tree.m_strings);
+
+        #define WLANG_AST(X, C) f(tree.m_##X##C.nodes); f(tree.m_##X##C.locations);
+        #include <frontend/ast/node_list.hpp>
+    }
+
+    AstCache::AstCache(std::filesystem::path directory):
+        m_directory(std::move(directory))
+    {}
+
+    uint64_t AstCache::key(std::string_view source) {
+        return std::hash<std::string_view>()(source);
+    }
+
+    uint64_t AstCache::layout() {
+        static const uint64_t value = [] {
+            std::string layout = fmt::format("flat {}", s_flat_version);
+            FlatTree tree(FileId {});
+            for_each_array(tree, [&](auto& array) {
+                static_assert(std::is_trivially_copyable_v<Element<decltype(array)>>);
+                layout += fmt::format(" {}", sizeof(Element<decltype(array)>));
+            });
+
+            #define WLANG_AST(X, C) layout += fmt::format(" {}", static_cast<int>(Flat::X##C::s_location));
+            #include <frontend/ast/node_list.hpp>
+
+            return std::hash<std::string>()(layout);
+        }();
+        return value;
+    }
+
+    std::filesystem::path AstCache::path(std::string_view source) const {
+        return m_directory / fmt::format("{:016x}-{}.ast", key(source), s_flat_version);
+    }
+
+    bool AstCache::valid(const FlatTree& tree, std::size_t source_size) {
+        if (tree.m_parameter_locations.size() != tree.m_parameters.size())
+            return false;
+        for (const FlatTree::Span& span : tree.m_parameter_locations) {
+            if (span.begin > span.end || span.end > source_size)
+                return false;
+        }
+
+        // indexed by NodeType, None first
+        std::vector<std::vector<bool>> reached(1);
+        std::size_t total = 0;
+        #define WLANG_AST(X, C)                                                       \
+            if (!locations_valid(tree.m_##X##C, source_size))                          \
+                return false;                                                         \
+            reached.emplace_back(tree.m_##X##C.nodes.size());                         \
+            total += tree.m_##X##C.nodes.size();
+        #include <frontend/ast/node_list.hpp>
+
+        // walked from the roots, a node reached twice is shared or in a cycle
+        std::vector<NodeHandle> pending;
+        std::size_t count = 0;
+
+        struct Links {
+            bool node(NodeHandle handle, bool optional) {
+                if (!handle)
+                    return optional;
+
+                auto type = static_cast<std::size_t>(handle.type());
+                if (type == 0 || type >= reached.size() || handle.index() >= reached[type].size() || reached[type][handle.index()])
+                    return false;
+
+                reached[type][handle.index()] = true;
+                count++;
+                pending.push_back(handle);
+                return true;
+            }
+
+            bool list(FlatRange range, bool may_be_empty) {
+                if (!contains(range, tree.m_children.size()) || (range.size == 0 && !may_be_empty))
+                    return false;
+                for (NodeHandle child : tree.children(range)) {
+                    if (!node(child, false))
+                        return false;
+                }
+                return true;
+            }
+
+            bool parameters(FlatRange range) {
+                if (!contains(range, tree.m_parameters.size()))
+                    return false;
+                for (const Flat::Parameter& parameter : tree.parameters(range)) {
+                    if (!node(parameter.type, true))
+                        return false;
+                }
+                return true;
+            }
+
+            bool string(FlatRange range) {
+                return contains(range, tree.m_strings.size());
+            }
+
+            const FlatTree& tree;
+            std::vector<std::vector<bool>>& reached;
+            std::vector<NodeHandle>& pending;
+            std::size_t& count;
+        };
+        Links walk { tree, reached, pending, count };
+
+        for (NodeHandle root : tree.m_roots) {
+            if (!walk.node(root, false))
+                return false;
+        }
+        while (!pending.empty()) {
+            NodeHandle handle = pending.back();
+            pending.pop_back();
+
+            bool linked = tree.visit(handle, [&]<typename T>(const T& node, NodeHandle) {
+                return links(node, walk);
+            });
+            if (!linked)
+                return false;
+        }
+
+        return count == total;
+    }
+
+    std::optional<FlatTree> AstCache::load(FileId file) const {
+        std::string_view source = SourceManager::global().file(file).content();
+
+        std::optional<SourceBuffer> buffer;
+        try {
+            buffer = SourceBuffer::map_file(path(source));
+        } catch (std::system_error&) {
+            return std::nullopt;
+        }
+        std::string_view image = buffer->view();
+
+        Header header;
+        if (image.size() < sizeof(header))
+            return std::nullopt;
+        std::memcpy(&header, image.data(), sizeof(header));
+
+        FlatTree tree(file);
+        uint32_t sections = 2;
+        for_each_array(tree, [&](auto&) { sections++; });
+
+        // the name of the file may collide, the header cannot
+        if (std::memcmp(header.magic, s_magic, sizeof(s_magic)) != 0 || header.sections != sections || header.layout != layout())
+            return std::nullopt;
+        if (header.source_size != source.size() || header.source_hash != key(source))
+            return std::nullopt;
+        if (image.size() < sizeof(header) + sections * sizeof(Section))
+            return std::nullopt;
+
+        std::vector<Section> table(sections);
+        std::memcpy(table.data(), image.data() + sizeof(header), sections * sizeof(Section));
+        for (const Section& section : table) {
+            if (section.offset > image.size() || section.size > image.size() - section.offset)
+                return std::nullopt;
+        }
+
+        // the names are the two last sections, they are interned first
+        const Section& ranges = table[sections - 2];
+        std::string_view names = image.substr(table[sections - 1].offset, table[sections - 1].size);
+        if (ranges.size % sizeof(FlatRange) != 0)
+            return std::nullopt;
+
+        std::vector<SymbolId> interned(ranges.size / sizeof(FlatRange));
+        for (std::size_t i = 0; i < interned.size(); i++) {
+            FlatRange range;
+            std::memcpy(&range, image.data() + ranges.offset + i * sizeof(FlatRange), sizeof(range));
+            if (range.begin > names.size() || range.size > names.size() - range.begin)
+                return std::nullopt;
+            interned[i] = SymbolTable::global().intern(names.substr(range.begin, range.size));
+        }
+
+        // the header only tells the image was written by store for this
+        // source, the arrays are checked before the tree is used
+        bool valid = true;
+        std::size_t index = 0;
+        for_each_array(tree, [&](auto& array) {
+            using T = Element<decltype(array)>;
+            const Section& section = table[index++];
+            if (section.size % sizeof(T) != 0) {
+                valid = false;
+                return;
+            }
+
+            array.resize(section.size / sizeof(T));
+            std::memcpy(array.data(), image.data() + section.offset, section.size);
+
+            if constexpr (HasSymbols<T>) {
+                for (T& node : array) {
+                    symbols(node, [&](SymbolId& symbol) {
+                        auto local = static_cast<std::size_t>(symbol);
+                        if (local < interned.size())
+                            symbol = interned[local];
+                        else
+                            valid = false;
+                    });
+                }
+            }
+        });
+
+        if (!valid || !AstCache::valid(tree, source.size()))
+            return std::nullopt;
+        return tree;
+    }
+
+    void AstCache::store(const FlatTree& tree) const {
+        std::string_view source = SourceManager::global().file(tree.file()).content();
+
+        std::string image(sizeof(Header), '\0');
+        std::vector<Section> table;
+
+        // the symbols become indices in the table of names
+        std::unordered_map<SymbolId, uint32_t> indices;
+        std::vector<FlatRange> ranges;
+        std::string names;
+        auto relocate = [&](SymbolId& symbol) {
+            auto [it, inserted] = indices.try_emplace(symbol, static_cast<uint32_t>(ranges.size()));
+            if (inserted) {
+                std::string_view name = SymbolTable::global().name(symbol);
+                ranges.push_back(FlatRange { static_cast<uint32_t>(names.size()), static_cast<uint32_t>(name.size()) });
+                names += name;
+            }
+            symbol = static_cast<SymbolId>(it->second);
+        };
+
+        auto append = [&](const void* data, std::size_t size) {
+            table.push_back(Section { image.size(), size });
+            image.append(static_cast<const char*>(data), size);
+            image.resize((image.size() + s_alignment - 1) / s_alignment * s_alignment, '\0');
+        };
+
+        for_each_array(tree, [&](const auto& array) {
+            using T = Element<decltype(array)>;
+            if constexpr (HasSymbols<T>) {
+                std::vector<T> relocated(array.begin(), array.end());
+                for (T& node : relocated)
+                    symbols(node, relocate);
+                append(relocated.data(), relocated.size() * sizeof(T));
+            } else {
+                append(array.data(), array.size() * sizeof(T));
+            }
+        });
+        append(ranges.data(), ranges.size() * sizeof(FlatRange));
+        append(names.data(), names.size());
+
+        // the table goes between the header and the first section
+        std::size_t table_size = table.size() * sizeof(Section);
+        for (Section& section : table)
+            section.offset += table_size;
+        image.insert(sizeof(Header), reinterpret_cast<const char*>(table.data()), table_size);
+
+        Header header = {
+            .magic = {},
+            .sections = static_cast<uint32_t>(table.size()),
+            .layout = layout(),
+            .source_hash = key(source),
+            .source_size = source.size(),
+        };
+        std::memcpy(header.magic, s_magic, sizeof(s_magic));
+        std::memcpy(image.data(), &header, sizeof(header));
+
+        // written aside then renamed, a concurrent load never sees half a
+        // file and two writers of the same source leave one of their copies
+        thread_local std::mt19937_64 random(std::random_device{}());
+        std::filesystem::path target = path(source);
+        std::filesystem::path temporary = target;
+        temporary += fmt::format(".{:016x}.tmp", random());
+
+        std::error_code error;
+        std::filesystem::create_directories(m_directory, error);
+        {
+            std::ofstream output(temporary, std::ios::binary);
+            output.write(image.data(), static_cast<std::streamsize>(image.size()));
+            if (!output.good()) {
+                output.close();
+                std::filesystem::remove(temporary, error);
+                return;
+            }
+        }
+
+        std::filesystem::rename(temporary, target, error);
+        if (error)
+            std::filesystem::remove(temporary, error);
+    }
+}
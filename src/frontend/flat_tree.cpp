@@ -0,0 +1,315 @@
+#include <frontend/ast/flat_tree.hpp>
+#include <frontend/lexer.hpp>
+#include <passes/pass.hpp>
+
+namespace W::Ast {
+    // flattens a pointer tree: every visit leaves the handle of the visited
+    // node in m_result, the children are flattened before their parent
+    struct FlatTreeBuilder : Passes::VisitorPass {
+        FlatTreeBuilder(FlatTree& tree):
+            m_tree(tree)
+        {}
+
+        NodeHandle flatten(Node* node) {
+            if (node == nullptr)
+                return NodeHandle();
+
+            node->visit(*this);
+            return m_result;
+        }
+
+        template<typename T>
+        FlatRange flatten_list(std::span<T*> nodes) {
+            // the children of the children are pushed on top in between
+            std::size_t base = m_pending.size();
+            for (T* node : nodes)
+                m_pending.push_back(flatten(node));
+
+            FlatRange range = {
+                static_cast<uint32_t>(m_tree.m_children.size()),
+                static_cast<uint32_t>(m_pending.size() - base),
+            };
+            m_tree.m_children.insert(m_tree.m_children.end(), m_pending.begin() + base, m_pending.end());
+            m_pending.erase(m_pending.begin() + base, m_pending.end());
+
+            return range;
+        }
+
+        template<typename T>
+        void emit(T node, const Location& location) {
+            m_result = m_tree.add(node, Location { location.file, location.begin + m_base, location.end + m_base });
+        }
+
+        void visit(AccessIdentifierExpression& expr) override {
+            emit(Flat::AccessIdentifierExpression { flatten_list(expr.members) }, expr.location);
+        }
+
+        void visit(CallExpression& expr) override {
+            NodeHandle callee = flatten(expr.callee);
+            emit(Flat::CallExpression { callee, flatten_list(expr.params) }, expr.location);
+        }
+
+        void visit(BinaryExpression& expr) override {
+            NodeHandle left = flatten(expr.left);
+            NodeHandle right = flatten(expr.right);
+            emit(Flat::BinaryExpression { left, right, expr.op }, expr.location);
+        }
+
+        void visit(UnaryExpression& expr) override {
+            emit(Flat::UnaryExpression { flatten(expr.expr), expr.op }, expr.location);
+        }
+
+        void visit(IdentExpression& expr) override {
+            emit(Flat::IdentExpression { expr.value }, expr.location);
+        }
+
+        void visit(ParentExpression& expr) override {
+            emit(Flat::ParentExpression { flatten(expr.expr) }, expr.location);
+        }
+
+        void visit(ArrayTypeExpression& expr) override {
+            NodeHandle lenght = flatten(expr.lenght);
+            NodeHandle inner_type = flatten(expr.inner_type);
+            emit(Flat::ArrayTypeExpression { lenght, inner_type }, expr.location);
+        }
+
+        void visit(SliceTypeExpression& expr) override {
+            emit(Flat::SliceTypeExpression { flatten(expr.inner_type) }, expr.location);
+        }
+
+        void visit(BoolLiteral& lit) override {
+            emit(Flat::BoolLiteral { lit.value }, lit.location);
+        }
+
+        void visit(IntLiteral& lit) override {
+            emit(Flat::IntLiteral { lit.value }, lit.location);
+        }
+
+        void visit(FloatLiteral& lit) override {
+            emit(Flat::FloatLiteral { lit.value }, lit.location);
+        }
+
+        void visit(EnumVariantLiteral& lit) override {
+            emit(Flat::EnumVariantLiteral { lit.value }, lit.location);
+        }
+
+        void visit(RuneLiteral& lit) override {
+            emit(Flat::RuneLiteral { lit.value }, lit.location);
+        }
+
+        void visit(StringLiteral& lit) override {
+            FlatRange value = {
+                static_cast<uint32_t>(m_tree.m_strings.size()),
+                static_cast<uint32_t>(lit.value.size()),
+            };
+            m_tree.m_strings.append(lit.value);
+            emit(Flat::StringLiteral { value }, lit.location);
+        }
+
+        void visit(ExpressionStatement& stmt) override {
+            emit(Flat::ExpressionStatement { flatten(stmt.expr), stmt.is_pub }, stmt.location);
+        }
+
+        void visit(DeclareFunctionStatement& stmt) override {
+            // the types of the parameters are flattened before the parameters
+            // are stored so they stay contiguous
+            std::size_t base = m_pending.size();
+            for (DeclareFunctionStatement::Parameter& parameter : stmt.parameters)
+                m_pending.push_back(parameter.type.is_expression() ? flatten(parameter.type.get_expression()) : NodeHandle());
+
+            FlatRange parameters = {
+                static_cast<uint32_t>(m_tree.m_parameters.size()),
+                static_cast<uint32_t>(stmt.parameters.size()),
+            };
+            for (std::size_t i = 0; i < stmt.parameters.size(); i++) {
+                DeclareFunctionStatement::Parameter& parameter = stmt.parameters[i];
+                m_tree.m_parameters.push_back(Flat::Parameter { parameter.modifiers, parameter.name, m_pending[base + i] });
+                m_tree.m_parameter_locations.push_back(FlatTree::Span { parameter.location.begin + m_base, parameter.location.end + m_base });
+            }
+            m_pending.erase(m_pending.begin() + base, m_pending.end());
+
+            NodeHandle return_type;
+            if (stmt.return_type.is_expression())
+                return_type = flatten(stmt.return_type.get_expression());
+
+            FlatRange body = flatten_list(stmt.body);
+            emit(Flat::DeclareFunctionStatement { stmt.name, return_type, parameters, body, stmt.is_pub }, stmt.location);
+        }
+
+        void visit(DeclareVariableStatement& stmt) override {
+            emit(Flat::DeclareVariableStatement { stmt.modifiers, stmt.name, flatten(stmt.value), stmt.is_pub }, stmt.location);
+        }
+
+        FlatTree& m_tree;
+        // added to the offsets of the flattened locations
+        uint32_t m_base = 0;
+        NodeHandle m_result;
+        std::vector<NodeHandle> m_pending;
+    };
+
+    FlatTree::FlatTree(FileId file):
+        m_file(file)
+    {}
+
+    FlatTree FlatTree::build(FileId file, std::span<const StatementPtr> statements) {
+        FlatTree tree(file);
+        FlatTreeBuilder builder(tree);
+
+        tree.m_roots.reserve(statements.size());
+        for (StatementPtr statement : statements)
+            tree.m_roots.push_back(builder.flatten(statement));
+
+        return tree;
+    }
+
+    FlatTree FlatTree::build(FileId file, std::span<const StatementPtr> statements, std::span<const uint32_t> bases) {
+        FlatTree tree(file);
+        FlatTreeBuilder builder(tree);
+
+        tree.m_roots.reserve(statements.size());
+        for (std::size_t i = 0; i < statements.size(); i++) {
+            builder.m_base = bases[i];
+            tree.m_roots.push_back(builder.flatten(statements[i]));
+        }
+
+        return tree;
+    }
+
+    std::size_t FlatTree::size() const {
+        std::size_t count = 0;
+        #define WLANG_AST(X, C) count += m_##X##C.nodes.size();
+        #include <frontend/ast/node_list.hpp>
+        return count;
+    }
+
+    template<typename T>
+    NodeHandle FlatTree::add(T node, const Location& location) {
+        NodeArray<T>& nodes = array<T>();
+        if (nodes.nodes.size() > NodeHandle::s_max_index)
+            utils::panic("too many nodes of the same kind in a file");
+
+        NodeHandle handle = NodeHandle::make(type_of<T>(), static_cast<uint32_t>(nodes.nodes.size()));
+        nodes.nodes.push_back(node);
+        if constexpr (T::s_location == LocationStorage::Span)
+            nodes.locations.push_back(Span { location.begin, location.end });
+        else if constexpr (T::s_location == LocationStorage::Begin)
+            nodes.locations.push_back(location.begin);
+
+        return handle;
+    }
+
+    FlatTree::Span FlatTree::span(NodeHandle handle) const {
+        return Span { begin(handle), end(handle) };
+    }
+
+    uint32_t FlatTree::begin(NodeHandle handle) const {
+        // a node without location starts with its first child, walked in a
+        // loop since a chain of binary expressions may be very deep
+        for (;;) {
+            switch (handle.type()) {
+                case NodeType::AccessIdentifierExpression:
+                    handle = children(get<Flat::AccessIdentifierExpression>(handle).members).front();
+                    break;
+                case NodeType::CallExpression:
+                    handle = get<Flat::CallExpression>(handle).callee;
+                    break;
+                case NodeType::BinaryExpression:
+                    handle = get<Flat::BinaryExpression>(handle).left;
+                    break;
+                case NodeType::ExpressionStatement:
+                    handle = get<Flat::ExpressionStatement>(handle).expr;
+                    break;
+                default:
+                    return visit(handle, [this]<typename T>(const T&, NodeHandle handle) -> uint32_t {
+                        if constexpr (T::s_location == LocationStorage::Span)
+                            return array<T>().locations[handle.index()].begin;
+                        else if constexpr (T::s_location == LocationStorage::Begin)
+                            return array<T>().locations[handle.index()];
+                        else
+                            utils::unreachable();
+                    });
+            }
+        }
+    }
+
+    uint32_t FlatTree::end(NodeHandle handle) const {
+        // calls and parentheses end with a bracket after their last child,
+        // looked for once the end of the innermost child is known
+        std::size_t brackets = 0;
+        uint32_t offset = 0;
+
+        for (bool found = false; !found;) {
+            switch (handle.type()) {
+                case NodeType::AccessIdentifierExpression:
+                    handle = children(get<Flat::AccessIdentifierExpression>(handle).members).back();
+                    break;
+                case NodeType::CallExpression: {
+                    const Flat::CallExpression& call = get<Flat::CallExpression>(handle);
+                    std::span<const NodeHandle> params = children(call.params);
+                    handle = params.empty() ? call.callee : params.back();
+                    brackets++;
+                    break;
+                }
+                case NodeType::BinaryExpression:
+                    handle = get<Flat::BinaryExpression>(handle).right;
+                    break;
+                case NodeType::UnaryExpression:
+                    handle = get<Flat::UnaryExpression>(handle).expr;
+                    break;
+                case NodeType::ParentExpression:
+                    handle = get<Flat::ParentExpression>(handle).expr;
+                    brackets++;
+                    break;
+                case NodeType::ArrayTypeExpression:
+                    handle = get<Flat::ArrayTypeExpression>(handle).inner_type;
+                    break;
+                case NodeType::SliceTypeExpression:
+                    handle = get<Flat::SliceTypeExpression>(handle).inner_type;
+                    break;
+                case NodeType::ExpressionStatement:
+                    handle = get<Flat::ExpressionStatement>(handle).expr;
+                    break;
+                case NodeType::DeclareFunctionStatement:
+                    offset = m_DeclareFunctionStatement.locations[handle.index()].end;
+                    found = true;
+                    break;
+                case NodeType::DeclareVariableStatement:
+                    offset = m_DeclareVariableStatement.locations[handle.index()].end;
+                    found = true;
+                    break;
+                case NodeType::EnumVariantLiteral: {
+                    // the dot then the name
+                    Lexer lexer(m_file, begin(handle));
+                    lexer.next();
+                    Token name = lexer.next();
+                    offset = name.offset + name.length;
+                    found = true;
+                    break;
+                }
+                default: {
+                    // identifiers and the other literals are a single token
+                    Token token = Lexer(m_file, begin(handle)).next();
+                    offset = token.offset + token.length;
+                    found = true;
+                    break;
+                }
+            }
+        }
+
+        if (brackets == 0)
+            return offset;
+
+        // only commas and the opening bracket of a call without argument
+        // come before a closing bracket
+        Lexer lexer(m_file, offset);
+        while (brackets > 0) {
+            Token token = lexer.next();
+            if (token.kind == TokenKind::Rpar || token.kind == TokenKind::Rsbr || token.kind == TokenKind::Eof) {
+                offset = token.offset + token.length;
+                brackets--;
+            }
+        }
+
+        return offset;
+    }
+}
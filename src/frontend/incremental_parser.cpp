@@ -0,0 +1,251 @@
+#include <algorithm>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+#include <frontend/incremental_parser.hpp>
+#include <frontend/lexer.hpp>
+#include <frontend/parallel_parser.hpp>
+#include <frontend/parser.hpp>
+#include <frontend/token_stream.hpp>
+#include <passes/static_pass.hpp>
+
+namespace W {
+    // moves the locations of parsed nodes by shift, to make them relative to
+    // their declaration
+    struct LocationShifter : Passes::StaticPass<LocationShifter> {
+        LocationShifter(int64_t shift):
+            m_shift(shift)
+        {}
+
+        void move(Location& location) {
+            location.begin = static_cast<uint32_t>(location.begin + m_shift);
+            location.end = static_cast<uint32_t>(location.end + m_shift);
+        }
+
+        void visit(Ast::Expression& expr) {
+            move(expr.location);
+            traverse(expr);
+        }
+
+        void visit(Ast::Statement& stmt) {
+            move(stmt.location);
+            traverse(stmt);
+        }
+
+        void visit(Ast::DeclareFunctionStatement& stmt) {
+            move(stmt.location);
+            for (Ast::DeclareFunctionStatement::Parameter& parameter : stmt.parameters)
+                move(parameter.location);
+            traverse(stmt);
+        }
+
+        int64_t m_shift;
+    };
+
+    // source of range in the version before the edit, rebuilt from the
+    // current one and the bytes removed by the edit
+    static std::string previous_text(std::string_view source, const TextEdit& edit, std::string_view removed, uint32_t begin, uint32_t end) {
+        uint32_t removed_end = edit.offset + edit.removed;
+        std::size_t shift = edit.inserted.size();
+
+        std::string text;
+        text.reserve(end - begin);
+        for (uint32_t offset = begin; offset < end; offset++) {
+            if (offset < edit.offset)
+                text += source[offset];
+            else if (offset < removed_end)
+                text += removed[offset - edit.offset];
+            else
+                text += source[offset - edit.removed + shift];
+        }
+        return text;
+    }
+
+    IncrementalParser::IncrementalParser(FileId file):
+        m_file(file),
+        m_tokens(Lexer(file).lex_all()),
+        m_parsed(0),
+        m_reused(0)
+    {
+        std::vector<Declaration> previous;
+        parse(previous, TextEdit { 0, 0, "" }, "");
+    }
+
+    void IncrementalParser::edit(const TextEdit& edit) {
+        // the file is edited in place, only the removed bytes are kept to
+        // compare the declarations touched by the edit
+        std::string removed(SourceManager::global().file(m_file).content().substr(edit.offset, edit.removed));
+        SourceManager::global().edit(m_file, edit);
+        Lexer::relex(m_tokens, m_file, edit);
+
+        std::vector<Declaration> previous = std::move(m_declarations);
+        if (m_parsed > 2 * m_tokens.size()) {
+            // the previous nodes are in the old arena, nothing is reused
+            previous.clear();
+            m_arena = utils::Arena();
+            m_parsed = 0;
+        }
+
+        parse(previous, edit, removed);
+    }
+
+    void IncrementalParser::parse(std::vector<Declaration>& previous, const TextEdit& edit, std::string_view removed) {
+        std::string_view source = m_tokens.source();
+
+        // the bytes out of the edit are the same in both versions, a
+        // declaration out of it is found in the previous version at the same
+        // offsets (shifted by the edit after it) without comparing its source
+        uint32_t edit_begin = edit.offset;
+        uint32_t edit_end = edit.offset + static_cast<uint32_t>(edit.inserted.size());
+        int64_t shift = static_cast<int64_t>(edit.inserted.size()) - edit.removed;
+        std::size_t cursor = 0;
+
+        // the declarations touched by the edit are looked up by hash, i.e.
+        // a declaration moved by the edit; the map is only built for them
+        struct Candidates {
+            std::vector<std::size_t> indices;
+            std::size_t next = 0;
+        };
+        std::unordered_map<std::size_t, Candidates> hashes;
+        bool hashed = false;
+        std::vector<bool> taken(previous.size());
+
+        // the tokens before the first declaration are a declaration too
+        std::vector<std::size_t> starts = ParallelParser::boundaries(m_tokens);
+        if (starts.empty() || starts.front() != 0)
+            starts.insert(starts.begin(), 0);
+        std::size_t eof = m_tokens.size() - 1;
+        if (eof == 0)
+            starts.clear();
+
+        m_declarations.clear();
+        m_declarations.reserve(starts.size());
+        m_reused = 0;
+
+        // the nodes are relative to the declaration, only it moves
+        auto reuse = [&](std::size_t index, uint32_t begin_offset) {
+            taken[index] = true;
+            Declaration& declaration = previous[index];
+            declaration.end = begin_offset + (declaration.end - declaration.begin);
+            declaration.begin = begin_offset;
+            m_declarations.push_back(declaration);
+            m_reused++;
+        };
+
+        for (std::size_t i = 0; i < starts.size(); i++) {
+            std::size_t begin = starts[i];
+            std::size_t end = i + 1 < starts.size() ? starts[i + 1] : eof;
+            uint32_t begin_offset = m_tokens.offsets()[begin];
+            // the Eof of its range is at the next declaration, an edit of the
+            // bytes in between moves the errors on this Eof
+            uint32_t end_offset = m_tokens.offsets()[end];
+
+            if (end_offset < edit_begin || begin_offset > edit_end) {
+                int64_t previous_begin = begin_offset - (begin_offset > edit_end ? shift : 0);
+                while (cursor < previous.size() && previous[cursor].begin < previous_begin)
+                    cursor++;
+
+                if (cursor < previous.size() && previous[cursor].begin == previous_begin && previous[cursor].end - previous[cursor].begin == end_offset - begin_offset) {
+                    reuse(cursor, begin_offset);
+                    continue;
+                }
+            }
+
+            std::string_view text = source.substr(begin_offset, end_offset - begin_offset);
+            std::size_t hash = std::hash<std::string_view>()(text);
+
+            if (!hashed) {
+                for (std::size_t j = 0; j < previous.size(); j++) {
+                    if (previous[j].end >= edit_begin && previous[j].begin <= edit.offset + edit.removed)
+                        hashes[previous[j].hash].indices.push_back(j);
+                }
+                hashed = true;
+            }
+
+            // the same source gives the same nodes, only their offsets change
+            bool reused = false;
+            if (auto it = hashes.find(hash); it != hashes.end()) {
+                Candidates& candidates = it->second;
+                for (std::size_t j = candidates.next; j < candidates.indices.size() && !reused; j++) {
+                    std::size_t index = candidates.indices[j];
+                    const Declaration& candidate = previous[index];
+                    // a collision of the hash
+                    if (taken[index] || previous_text(source, edit, removed, candidate.begin, candidate.end) != text)
+                        continue;
+
+                    reuse(index, begin_offset);
+                    reused = true;
+                }
+
+                while (candidates.next < candidates.indices.size() && taken[candidates.indices[candidates.next]])
+                    candidates.next++;
+            }
+
+            if (!reused) {
+                m_declarations.push_back(parse_declaration(begin, end));
+                m_declarations.back().hash = hash;
+            }
+        }
+
+        m_statements.clear();
+        m_bases.clear();
+        m_diagnostics.clear();
+        for (const Declaration& declaration : m_declarations) {
+            m_statements.insert(m_statements.end(), declaration.statements.begin(), declaration.statements.end());
+            m_bases.insert(m_bases.end(), declaration.statements.size(), declaration.begin);
+            for (Diagnostic diagnostic : declaration.diagnostics) {
+                diagnostic.location.begin += declaration.begin;
+                diagnostic.location.end += declaration.begin;
+                m_diagnostics.push_back(diagnostic);
+            }
+        }
+
+        // belongs to the whole file, an edit anywhere may fix it
+        if (auto offset = SourceManager::global().file(m_file).invalid_utf8()) {
+            LexerInvalidUtf8Error error(Location { m_file, *offset, *offset + 1 });
+            m_diagnostics.insert(m_diagnostics.begin(), Diagnostic {
+                .type = error.get_type(),
+                .location = error.get_location(),
+                .message = m_arena.make_string(error.get_message()),
+            });
+        }
+    }
+
+    IncrementalParser::Declaration IncrementalParser::parse_declaration(std::size_t begin, std::size_t end) {
+        TokenStream token_stream(m_tokens, begin, end);
+        Diagnostics diagnostics;
+        Parser parser(token_stream, m_arena, diagnostics);
+
+        std::vector<Ast::StatementPtr> statements;
+        while (token_stream.peek().kind != TokenKind::Eof) {
+            if (Ast::StatementPtr stmt = parser.next())
+                statements.push_back(stmt);
+        }
+        m_parsed += end - begin;
+
+        uint32_t begin_offset = m_tokens.offsets()[begin];
+        LocationShifter shifter(-static_cast<int64_t>(begin_offset));
+        shifter.dispatch(std::span<Ast::StatementPtr>(statements));
+
+        // the messages are moved to the arena with the nodes, the UTF-8
+        // error is reported for the whole file
+        std::vector<Diagnostic> reported;
+        for (Diagnostic diagnostic : diagnostics.all()) {
+            if (diagnostic.type == ExceptionType::LexerInvalidUtf8)
+                continue;
+            diagnostic.message = m_arena.make_string(diagnostic.message);
+            shifter.move(diagnostic.location);
+            reported.push_back(diagnostic);
+        }
+
+        return Declaration {
+            .hash = 0,
+            .begin = begin_offset,
+            .end = m_tokens.offsets()[end],
+            .statements = m_arena.make_span(std::span<Ast::StatementPtr>(statements)),
+            .diagnostics = m_arena.make_span(std::span<Diagnostic>(reported)),
+        };
+    }
+}
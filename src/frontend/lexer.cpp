@@ -1,4 +1,8 @@
 #include <algorithm>
+#include <array>
+#include <charconv>
+#include <cstdint>
+#include <cstring>
 #include <utility>
 #include <optional>
 #include <string>
@@ -8,6 +12,7 @@
 #include <frozen/unordered_map.h>
 
 #include <frontend/lexer.hpp>
+#include <frontend/scanners.hpp>
 #include <utils/macros.hpp>
 
 namespace W {
@@ -55,7 +60,8 @@ namespace W {
         { "unsafe", TokenKind::KeyUnsafe },
     });
 
-    constexpr auto s_operations = frozen::make_unordered_map<frozen::string, TokenKind>({
+    // order does not matter, the longest operator always wins
+    constexpr std::pair<std::string_view, TokenKind> s_operations[] = {
         { ">>>=", TokenKind::UnsignedRightShiftAssign },
         { ">>>", TokenKind::UnsignedRightShift },
         { "<<=", TokenKind::RightShiftAssign },
@@ -110,49 +116,195 @@ namespace W {
         { "...", TokenKind::Ellipsis },
         { "..", TokenKind::Dotdot },
         { ".", TokenKind::Dot },
-    });
+    };
+
+    // trie of every operator built at compile time, each state is a row of
+    // transitions indexed by the class of the next byte (only the bytes used
+    // by an operator get a class, the others stop the match)
+    struct OperatorTrie {
+        static constexpr std::size_t max_length = 4;
+        static constexpr std::size_t max_states = 64;
+        static constexpr std::size_t max_classes = 32;
+
+        std::array<uint8_t, 128> classes {};
+        std::array<std::array<uint8_t, max_classes>, max_states> transitions {};
+        std::array<TokenKind, max_states> accepts {};
+
+        constexpr OperatorTrie() {
+            std::size_t class_count = 1;
+            std::size_t state_count = 1;
+
+            accepts.fill(TokenKind::Unknown);
+            for (auto [op, kind] : s_operations) {
+                if (op.empty() || op.size() > max_length)
+                    throw "operators must have between 1 and max_length bytes";
+
+                std::size_t state = 0;
+                for (char c : op) {
+                    uint8_t& klass = classes.at(static_cast<unsigned char>(c));
+                    if (klass == 0) {
+                        if (class_count == max_classes)
+                            throw "too many distinct operator bytes";
+                        klass = static_cast<uint8_t>(class_count++);
+                    }
+
+                    uint8_t& next = transitions[state][klass];
+                    if (next == 0) {
+                        if (state_count == max_states)
+                            throw "too many operator prefixes";
+                        next = static_cast<uint8_t>(state_count++);
+                    }
+                    state = next;
+                }
 
-    Lexer::Lexer(std::filesystem::path path, std::istream& input): 
-        m_path(std::make_shared<std::filesystem::path>(std::move(path))),
-        m_input(input)
-    {
-        for (size_t i = 0; i < LEXER_BUFFER_SIZE; i++) {
-            int32_t c = m_input.get();
-            m_working_buffer[i] = c != EOF ? (char)c : 0;
+                if (accepts[state] != TokenKind::Unknown)
+                    throw "duplicated operator";
+                accepts[state] = kind;
+            }
         }
+    };
+
+    constexpr OperatorTrie s_operator_trie;
+
+    Lexer::Lexer(std::filesystem::path path, std::istream& input):
+        Lexer(std::move(path), SourceBuffer::load(input))
+    {}
+
+    Lexer::Lexer(std::filesystem::path path, SourceBuffer source):
+        Lexer(SourceManager::global().add(std::move(path), std::move(source)))
+    {}
+
+    Lexer::Lexer(FileId file, uint32_t offset):
+        m_file(file),
+        m_source(SourceManager::global().file(file).content()),
+        m_cursor(m_source.data() + std::min<std::size_t>(offset, m_source.size())),
+        m_end(m_source.data() + m_source.size())
+    {
+        if (m_source.size() > UINT32_MAX)
+            panic("the source file %s is bigger than 4GiB\n", SourceManager::global().file(file).path().c_str());
     }
 
+    Lexer::Lexer(std::string_view window):
+        m_file(),
+        m_source(window),
+        m_cursor(window.data()),
+        m_end(window.data() + window.size())
+    {}
+
     char Lexer::buffer_at(std::size_t i) {
-        return m_working_buffer.at(i);
+        return i < static_cast<std::size_t>(m_end - m_cursor) ? m_cursor[i] : 0;
     }
 
     bool Lexer::start_with(std::string_view x) {
-        return std::string_view(m_working_buffer.begin(), m_working_buffer.begin() + x.size()) == x;
+        return std::string_view(m_cursor, m_end - m_cursor).starts_with(x);
     }
 
     void Lexer::advance(size_t offset) {
-        // shift the whole buffer by offset
-        std::shift_left(m_working_buffer.begin(), m_working_buffer.end(), offset);
-
-        for (size_t i = 0; i < offset; i++) {
-            int32_t c = m_input.get();
-            m_working_buffer[LEXER_BUFFER_SIZE - offset + i] = c != EOF ? (char)c : 0;
-            if (c == '\n') {
-                m_line += 1;
-                m_col = 0;
-            } else {
-                m_col += 1;
-            }
-        }
+        advance_to(m_cursor + std::min<size_t>(offset, m_end - m_cursor));
+    }
+
+    void Lexer::advance_to(const char* target) {
+        m_cursor = target;
     }
 
     void Lexer::skip_whitespace() {
-        while (std::isspace(buffer_at()) && !finished())
-            advance();
+        advance_to(Scanners::skip_whitespace(m_cursor, m_end));
     }
 
     bool Lexer::finished() {
-        return m_working_buffer.at(0) == 0;
+        return buffer_at() == 0;
+    }
+
+    TokenBuffer Lexer::lex_all() {
+        TokenBuffer tokens(m_file);
+        // roughly one token every 4 bytes on real sources
+        tokens.reserve((m_end - m_cursor) / 4 + 1);
+
+        Token token;
+        do {
+            token = next();
+            tokens.push_back(token);
+        } while (token.kind != TokenKind::Eof);
+
+        return tokens;
+    }
+
+    TokenBuffer Lexer::lex_stream(std::filesystem::path path, StreamReader& input) {
+        input.refill();
+        Lexer lexer(input.view());
+        TokenBuffer tokens;
+
+        // offset of the last token lexed again after a refill
+        std::size_t pending = SIZE_MAX;
+        for (;;) {
+            const char* start = lexer.m_cursor;
+            Token token = lexer.next();
+
+            // the last token (or the whitespace or the comment before it) may
+            // continue in the bytes not read yet, and an operator looks up to
+            // OperatorTrie::max_length bytes ahead; the window only grows so
+            // it is enough to lex the token again after a refill (from its
+            // offset, the bytes may have moved), a token which still does not
+            // fit (a huge comment) doubles the window so it is not lexed again
+            // for every chunk
+            if (!input.exhausted() && static_cast<std::size_t>(lexer.m_end - lexer.m_cursor) <= OperatorTrie::max_length) {
+                std::size_t offset = start - lexer.m_source.data();
+                input.refill(offset == pending ? input.view().size() : 0);
+                pending = offset;
+
+                lexer.m_source = input.view();
+                lexer.m_cursor = lexer.m_source.data() + offset;
+                lexer.m_end = lexer.m_source.data() + lexer.m_source.size();
+                continue;
+            }
+
+            tokens.push_back(token);
+            if (token.kind == TokenKind::Eof)
+                break;
+        }
+
+        tokens.bind(SourceManager::global().add(std::move(path), input.finish()));
+        return tokens;
+    }
+
+    void Lexer::relex(TokenBuffer& tokens, FileId file, const TextEdit& edit) {
+        std::span<const uint32_t> offsets = tokens.offsets();
+        std::span<const uint32_t> lengths = tokens.lengths();
+        int64_t shift = static_cast<int64_t>(edit.inserted.size()) - edit.removed;
+
+        // a token depends on the bytes up to OperatorTrie::max_length after
+        // its end (the longest match of the operators), the ones ending
+        // further from the edit are kept
+        std::size_t begin = std::lower_bound(offsets.begin(), offsets.end(), edit.offset) - offsets.begin();
+        while (begin > 0 && offsets[begin - 1] + lengths[begin - 1] + OperatorTrie::max_length > edit.offset)
+            begin--;
+
+        uint32_t position = begin > 0 ? offsets[begin - 1] + lengths[begin - 1] : 0;
+        Lexer lexer(file, position);
+        TokenBuffer relexed(file);
+
+        // the lexer only depends on the bytes after its position, so once a
+        // token past the edit starts where a previous one started the rest of
+        // the tokens are the same
+        std::size_t end = tokens.size();
+        for (;;) {
+            Token token = lexer.next();
+
+            if (token.offset >= edit.offset + edit.inserted.size()) {
+                uint32_t previous = static_cast<uint32_t>(token.offset - shift);
+                auto it = std::lower_bound(offsets.begin() + begin, offsets.end(), previous);
+                if (it != offsets.end() && *it == previous) {
+                    end = it - offsets.begin();
+                    break;
+                }
+            }
+
+            relexed.push_back(token);
+            if (token.kind == TokenKind::Eof)
+                break;
+        }
+
+        tokens.splice(begin, end, relexed, shift);
     }
 
     Token Lexer::next() {
@@ -162,7 +314,8 @@ namespace W {
             skip_whitespace();
         }
 
-        Token token = {Location{m_path, m_line, m_col, 0, 0}, TokenKind::Unknown, {}};
+        const char* start = m_cursor;
+        Token token = {static_cast<uint32_t>(start - m_source.data()), 0, 0, TokenKind::Unknown};
 
         if (finished()) {
             token.kind = TokenKind::Eof;
@@ -177,108 +330,302 @@ namespace W {
             read_number(token);
         else if (c == '"' || c == '\'' || c == '`')
             read_string_or_rune(token, c);
-        else {
-            for (auto op : s_operations) {
-                if (start_with(op.first.data())) {
-                    token.kind = op.second;
-                    advance(op.first.size());
-                    break;
-                }
-            }
-        }
+        else
+            read_operator(token);
 
-        token.location.end_line = m_line;
-        token.location.end_col = m_col;
+        token.length = static_cast<uint32_t>(m_cursor - start);
 
         return token;
     }
 
     void Lexer::read_ident(Token& token) {
-        char c = buffer_at();
-        std::string data;
-
-        while (std::isalnum(c) || c == '_') {
-            data.push_back(c);
-            advance();
-            c = buffer_at();
-        }
+        const char* start = m_cursor;
+        // identifiers never contain a newline, no need to track the lines
+        m_cursor = Scanners::skip_ident(m_cursor, m_end);
 
-        if (auto it = s_reserved_keywords.find(std::string_view(data)); it == s_reserved_keywords.end()) {
+        std::string_view data(start, m_cursor - start);
+        if (auto it = s_reserved_keywords.find(data); it == s_reserved_keywords.end()) {
             token.kind = TokenKind::Ident;
-            token.raw = data;
+            token.payload = static_cast<uint32_t>(SymbolTable::global().intern(data));
         } else
             token.kind = it->second;
     }
 
-    void Lexer::read_number(Token& token) {
-        char c = buffer_at();
-        std::string raw;
+    void Lexer::read_operator(Token& token) {
+        // longest match, at most OperatorTrie::max_length transitions
+        std::size_t state = 0;
+        std::size_t length = 0;
+        for (std::size_t i = 0; i < OperatorTrie::max_length; i++) {
+            unsigned char c = buffer_at(i);
+            if (c >= s_operator_trie.classes.size())
+                break;
+
+            state = s_operator_trie.transitions[state][s_operator_trie.classes[c]];
+            if (state == 0)
+                break;
+
+            if (s_operator_trie.accepts[state] != TokenKind::Unknown) {
+                token.kind = s_operator_trie.accepts[state];
+                length = i + 1;
+            }
+        }
 
-        while (isxdigit(c) || c == '_') {
-            raw.push_back(c);
+        // always consume at least one byte so an unknown byte cannot stall
+        // the lexer
+        advance(length != 0 ? length : 1);
+    }
+
+    static bool is_digit(char c) {
+        return static_cast<unsigned char>(c - '0') <= 9;
+    }
+
+    // from_chars does not know the `_` separators, they are only removed
+    // (in a copy) when the literal has some
+    template<typename F>
+    static LiteralId decode_without_separators(std::string_view digits, F decode) {
+        if (digits.find('_') == std::string_view::npos)
+            return decode(digits);
+
+        std::string copy;
+        copy.reserve(digits.size());
+        for (char c : digits) {
+            if (c != '_')
+                copy.push_back(c);
+        }
+        return decode(std::string_view(copy));
+    }
+
+    template<typename T>
+    static bool decode_chars(std::string_view digits, T& value, LiteralId& error, auto... format) {
+        auto [end, code] = std::from_chars(digits.data(), digits.data() + digits.size(), value, format...);
+        if (code == std::errc::result_out_of_range)
+            error = LiteralId::OutOfRange;
+        else if (code != std::errc() || end != digits.data() + digits.size())
+            error = LiteralId::Invalid;
+        else
+            return true;
+        return false;
+    }
+
+    static LiteralId decode_integer(std::string_view digits, int base) {
+        return decode_without_separators(digits, [base](std::string_view digits) {
+            uint64_t value;
+            LiteralId error;
+            if (!decode_chars(digits, value, error, base))
+                return error;
+            return LiteralTable::global().intern_integer(value);
+        });
+    }
+
+    static LiteralId decode_float(std::string_view digits) {
+        return decode_without_separators(digits, [](std::string_view digits) {
+            double value;
+            LiteralId error;
+            if (!decode_chars(digits, value, error, std::chars_format::general))
+                return error;
+            return LiteralTable::global().intern_float(value);
+        });
+    }
+
+    void Lexer::skip_digits() {
+        while (is_digit(buffer_at()) || buffer_at() == '_')
             advance();
-            c = buffer_at();
+    }
+
+    void Lexer::read_number(Token& token) {
+        const char* start = m_cursor;
+        token.kind = TokenKind::Integer;
+
+        int base = 10;
+        if (buffer_at() == '0') {
+            switch (buffer_at(1) | 0x20) {
+                case 'x': base = 16; break;
+                case 'o': base = 8; break;
+                case 'b': base = 2; break;
+            }
         }
 
-        if (c == '.') {
-            do {
-                raw.push_back(c);
-                advance();
-                c = buffer_at();
-            } while (isxdigit(c) || c == '_');
+        if (base != 10) {
+            advance(2);
+            const char* digits = m_cursor;
+            // the digits are validated by from_chars
+            m_cursor = Scanners::skip_ident(m_cursor, m_end);
+            token.payload = static_cast<uint32_t>(decode_integer(std::string_view(digits, m_cursor - digits), base));
+            return;
+        }
 
+        skip_digits();
+        // `1..2` is a range, not a float
+        if (buffer_at() == '.' && is_digit(buffer_at(1))) {
+            advance();
+            skip_digits();
             token.kind = TokenKind::Float;
-        } else {
-            token.kind = TokenKind::Integer;
         }
-        token.raw = raw;
+        if ((buffer_at() | 0x20) == 'e') {
+            std::size_t sign = buffer_at(1) == '+' || buffer_at(1) == '-';
+            if (is_digit(buffer_at(1 + sign))) {
+                advance(1 + sign);
+                skip_digits();
+                token.kind = TokenKind::Float;
+            }
+        }
+
+        std::string_view digits(start, m_cursor - start);
+        // letters glued to the literal belong to the token but make it invalid
+        m_cursor = Scanners::skip_ident(m_cursor, m_end);
+        if (m_cursor != digits.data() + digits.size())
+            token.payload = static_cast<uint32_t>(LiteralId::Invalid);
+        else if (token.kind == TokenKind::Float)
+            token.payload = static_cast<uint32_t>(decode_float(digits));
+        else
+            token.payload = static_cast<uint32_t>(decode_integer(digits, 10));
     }
 
     void Lexer::read_comment(bool is_multiline) {
-        char c = buffer_at();
         advance(2);
 
         if (is_multiline) {
             int32_t nesting = 0;
-            while (c != 0) {
+            // only jumps on '*', '/' or \0, none of the other bytes can start
+            // a delimiter
+            advance_to(Scanners::find_comment_delimiter(m_cursor, m_end));
+            while (!finished()) {
                 if (start_with("*/")) {
                     if (!nesting) break;
                     nesting--;
                 } else if (start_with("/*")) nesting++;
                 advance();
-                c = buffer_at();
+                advance_to(Scanners::find_comment_delimiter(m_cursor, m_end));
             }
             // skiping */
             advance(2);
         } else {
-            while (c != '\n') {
-                advance();
-                c = buffer_at();
+            m_cursor = Scanners::find_line_end(m_cursor, m_end);
+        }
+    }
+
+    static void append_utf8(std::string& out, uint32_t code_point) {
+        if (code_point < 0x80) {
+            out.push_back(static_cast<char>(code_point));
+        } else if (code_point < 0x800) {
+            out.push_back(static_cast<char>(0xc0 | code_point >> 6));
+            out.push_back(static_cast<char>(0x80 | (code_point & 0x3f)));
+        } else if (code_point < 0x10000) {
+            out.push_back(static_cast<char>(0xe0 | code_point >> 12));
+            out.push_back(static_cast<char>(0x80 | (code_point >> 6 & 0x3f)));
+            out.push_back(static_cast<char>(0x80 | (code_point & 0x3f)));
+        } else {
+            out.push_back(static_cast<char>(0xf0 | code_point >> 18));
+            out.push_back(static_cast<char>(0x80 | (code_point >> 12 & 0x3f)));
+            out.push_back(static_cast<char>(0x80 | (code_point >> 6 & 0x3f)));
+            out.push_back(static_cast<char>(0x80 | (code_point & 0x3f)));
+        }
+    }
+
+    // reads the hexadecimal digits of \xhh or \u{h...} at the start of raw,
+    // returns the number of bytes used or 0 if they are invalid
+    static std::size_t read_escaped_code_point(std::string_view raw, uint32_t& code_point) {
+        bool braced = raw.starts_with("u{");
+        std::size_t digits = raw.starts_with('x') ? 1 : braced ? 2 : 0;
+        if (digits == 0)
+            return 0;
+
+        std::size_t last = braced ? raw.find('}', digits) : std::min<std::size_t>(digits + 2, raw.size());
+        if (last == std::string_view::npos || last == digits || (!braced && last != digits + 2))
+            return 0;
+
+        auto [end, code] = std::from_chars(raw.data() + digits, raw.data() + last, code_point, 16);
+        if (code != std::errc() || end != raw.data() + last)
+            return 0;
+        if (braced && (code_point > 0x10ffff || (code_point >= 0xd800 && code_point <= 0xdfff)))
+            return 0;
+
+        return last + braced;
+    }
+
+    // single pass over the body of a string or a rune with at least one escape
+    static LiteralId decode_escapes(std::string_view raw) {
+        // reused between the literals, only the interned copy is kept
+        thread_local std::string decoded;
+        decoded.clear();
+
+        for (;;) {
+            std::size_t escape = raw.find('\\');
+            decoded.append(raw.substr(0, escape));
+            if (escape == std::string_view::npos)
+                break;
+
+            raw.remove_prefix(escape + 1);
+            if (raw.empty())
+                return LiteralId::Invalid;
+
+            std::size_t used = 1;
+            switch (raw[0]) {
+                case 'n': decoded.push_back('\n'); break;
+                case 't': decoded.push_back('\t'); break;
+                case 'r': decoded.push_back('\r'); break;
+                case '0': decoded.push_back('\0'); break;
+                case '\\':
+                case '\'':
+                case '"':
+                case '`':
+                    decoded.push_back(raw[0]);
+                    break;
+                case 'x':
+                case 'u': {
+                    uint32_t code_point;
+                    used = read_escaped_code_point(raw, code_point);
+                    if (used == 0)
+                        return LiteralId::Invalid;
+
+                    // \xhh is a raw byte, \u{h...} a code point
+                    if (raw[0] == 'x')
+                        decoded.push_back(static_cast<char>(code_point));
+                    else
+                        append_utf8(decoded, code_point);
+                    break;
+                }
+                default:
+                    return LiteralId::Invalid;
             }
+            raw.remove_prefix(used);
         }
+
+        return LiteralTable::global().intern_string(decoded);
     }
 
     void Lexer::read_string_or_rune(Token& token, char open_quote) {
-        std::string data;
         // skip open ", ' or `
         advance();
-
-        char c = buffer_at();
-        bool ignore_next = false;
-        while (c > 0 && (c != open_quote || ignore_next)) {
-            ignore_next = c == '\\';
-            data.push_back(c);
-            advance();
-            c = buffer_at();
+        const char* body = m_cursor;
+
+        // only jumps on quotes, backslashes or \0, the escaped byte is skipped
+        // with its backslash
+        bool has_escape = false;
+        for (;;) {
+            advance_to(Scanners::find_string_delimiter(m_cursor, m_end));
+            char c = buffer_at();
+
+            if (c == open_quote)
+                break;
+            // an unterminated string or rune runs until the end of the file,
+            // the parser reports it as an unknown token
+            if (c == 0)
+                return;
+
+            has_escape |= c == '\\';
+            advance(c == '\\' ? 2 : 1);
         }
 
+        token.payload = static_cast<uint32_t>(
+            has_escape ? decode_escapes(std::string_view(body, m_cursor - body)) : LiteralId::Raw
+        );
+
         // skip close ", ' or `
-        if (c == open_quote) advance();
-        else todof("error to find `%c` at the end of the string or the rune", open_quote);
-        
+        advance();
         token.kind = open_quote == '`' ? TokenKind::Rune : TokenKind::String;
-        token.raw = data;
     }
+
 }
 
 auto fmt::formatter<W::TokenKind>::format(W::TokenKind kind, format_context& ctx) const -> format_context::iterator {
@@ -0,0 +1,161 @@
+#include <algorithm>
+#include <optional>
+#include <thread>
+
+#include <frontend/lexer.hpp>
+#include <frontend/parallel_lexer.hpp>
+#include <frontend/scanners.hpp>
+
+namespace W {
+    // how far after a chunk start a `*/` is looked for
+    static constexpr std::size_t s_comment_lookahead = 4096;
+
+    ParallelLexer::ParallelLexer(FileId file):
+        ParallelLexer(file, Options())
+    {}
+
+    ParallelLexer::ParallelLexer(FileId file, Options options):
+        m_file(file),
+        m_source(SourceManager::global().file(file).content()),
+        m_options(options)
+    {}
+
+    TokenBuffer ParallelLexer::lex_all() {
+        std::vector<uint32_t> starts = chunk_starts();
+        if (starts.size() <= 1)
+            return Lexer(m_file).lex_all();
+
+        std::vector<TokenBuffer> chunks;
+        chunks.reserve(starts.size());
+        for (std::size_t i = 0; i < starts.size(); i++)
+            chunks.emplace_back(m_file);
+
+        std::optional<utils::ThreadPool> own_pool;
+        utils::ThreadPool* pool = m_options.pool;
+        if (pool == nullptr)
+            pool = &own_pool.emplace(static_cast<unsigned>(starts.size()));
+
+        pool->run_all(starts.size(), [&](std::size_t i) {
+            uint32_t end = i + 1 < starts.size() ? starts[i + 1] : static_cast<uint32_t>(m_source.size());
+            chunks[i] = lex_chunk(starts[i], end);
+        });
+
+        return stitch(chunks, starts);
+    }
+
+    std::size_t ParallelLexer::threads() const {
+        if (m_options.pool != nullptr)
+            return m_options.pool->size();
+        return m_options.threads != 0 ? m_options.threads : std::thread::hardware_concurrency();
+    }
+
+    std::vector<uint32_t> ParallelLexer::chunk_starts() const {
+        std::size_t size = m_source.size();
+        if (size < m_options.threshold || size == 0)
+            return { 0 };
+
+        std::size_t count = std::min(std::max<std::size_t>(threads(), 1), size / std::max<std::size_t>(m_options.min_chunk_size, 1));
+
+        std::vector<uint32_t> starts = { 0 };
+        for (std::size_t i = 1; i < count; i++) {
+            uint32_t start = speculative_start(static_cast<uint32_t>(size * i / count));
+            // a chunk swallowed by the lookahead of the previous one is dropped
+            if (start > starts.back() && start < size)
+                starts.push_back(start);
+        }
+
+        return starts;
+    }
+
+    uint32_t ParallelLexer::speculative_start(uint32_t boundary) const {
+        const char* begin = m_source.data();
+        const char* end = begin + m_source.size();
+
+        // tokens never span a line outside strings, runes and comments
+        const char* it = Scanners::find_line_end(begin + boundary, end);
+        while (it < end && *it != '\n')
+            it = Scanners::find_line_end(it + 1, end);
+        if (it == end)
+            return static_cast<uint32_t>(m_source.size());
+        it++;
+
+        // a `*/` before any `/*` or `//` means the line is most likely in a
+        // block comment, start right after it
+        const char* lookahead = it + std::min<std::size_t>(s_comment_lookahead, end - it);
+        for (const char* delimiter = Scanners::find_comment_delimiter(it, lookahead);
+             delimiter + 1 < lookahead;
+             delimiter = Scanners::find_comment_delimiter(delimiter + 1, lookahead)) {
+            if (delimiter[0] == '/' && (delimiter[1] == '*' || delimiter[1] == '/'))
+                break;
+            if (delimiter[0] == '*' && delimiter[1] == '/') {
+                it = delimiter + 2;
+                break;
+            }
+        }
+
+        return static_cast<uint32_t>(it - begin);
+    }
+
+    TokenBuffer ParallelLexer::lex_chunk(uint32_t begin, uint32_t end) const {
+        Lexer lexer(m_file, begin);
+        TokenBuffer tokens(m_file);
+        tokens.reserve((end - begin) / 4 + 1);
+
+        // the last token may run past the end (i.e. a string), the next chunk
+        // owns every token starting at or after the end
+        for (;;) {
+            Token token = lexer.next();
+            if (token.kind == TokenKind::Eof || token.offset >= end)
+                break;
+            tokens.push_back(token);
+        }
+
+        return tokens;
+    }
+
+    TokenBuffer ParallelLexer::stitch(std::vector<TokenBuffer>& chunks, const std::vector<uint32_t>& starts) const {
+        TokenBuffer tokens(m_file);
+        std::size_t total = 1;
+        for (const TokenBuffer& chunk : chunks)
+            total += chunk.size();
+        tokens.reserve(total);
+
+        // the first chunk starts at the beginning of the file, it is always
+        // right
+        tokens.append(chunks[0]);
+        uint32_t position = 0;
+        if (!tokens.empty())
+            position = tokens.offsets().back() + tokens.lengths().back();
+
+        std::size_t chunk = 1;
+        for (;;) {
+            // relexes from the real position until a token starts where a
+            // speculative one does, the lexer only depends on the position so
+            // both sequences are the same from there
+            Lexer lexer(m_file, position);
+            for (;;) {
+                Token token = lexer.next();
+                if (token.kind == TokenKind::Eof) {
+                    tokens.push_back(token);
+                    return tokens;
+                }
+
+                while (chunk + 1 < starts.size() && starts[chunk + 1] <= token.offset)
+                    chunk++;
+
+                if (chunk < starts.size() && token.offset >= starts[chunk]) {
+                    std::span<const uint32_t> offsets = chunks[chunk].offsets();
+                    auto it = std::lower_bound(offsets.begin(), offsets.end(), token.offset);
+                    if (it != offsets.end() && *it == token.offset) {
+                        tokens.append(chunks[chunk], it - offsets.begin());
+                        position = tokens.offsets().back() + tokens.lengths().back();
+                        chunk++;
+                        break;
+                    }
+                }
+
+                tokens.push_back(token);
+            }
+        }
+    }
+}
@@ -0,0 +1,185 @@
+#include <algorithm>
+#include <optional>
+#include <thread>
+
+#include <frontend/parallel_parser.hpp>
+#include <frontend/parser.hpp>
+#include <frontend/token_stream.hpp>
+
+namespace W {
+    ParallelParser::ParallelParser(const TokenBuffer& tokens):
+        ParallelParser(tokens, Options())
+    {}
+
+    ParallelParser::ParallelParser(const TokenBuffer& tokens, Options options):
+        m_tokens(&tokens),
+        m_options(options)
+    {}
+
+    std::vector<Ast::StatementPtr> ParallelParser::parse_all(utils::Arena& arena, Diagnostics& diagnostics) {
+        std::vector<std::size_t> starts = chunk_starts();
+        std::size_t eof = m_tokens->size() - 1;
+
+        std::vector<Chunk> chunks(starts.size());
+        if (starts.size() <= 1) {
+            parse_chunk(0, eof, chunks[0]);
+        } else {
+            std::optional<utils::ThreadPool> own_pool;
+            utils::ThreadPool* pool = m_options.pool;
+            if (pool == nullptr)
+                pool = &own_pool.emplace(static_cast<unsigned>(starts.size()));
+
+            pool->run_all(starts.size(), [&](std::size_t i) {
+                std::size_t end = i + 1 < starts.size() ? starts[i + 1] : eof;
+                parse_chunk(starts[i], end, chunks[i]);
+            });
+        }
+
+        std::size_t total = 0;
+        for (const Chunk& chunk : chunks)
+            total += chunk.statements.size();
+
+        std::vector<Ast::StatementPtr> statements;
+        statements.reserve(total);
+
+        for (std::size_t i = 0; i < chunks.size();) {
+            Chunk& chunk = chunks[i];
+            arena.adopt(std::move(chunk.arena));
+
+            if (chunk.last_clean || i + 1 == chunks.size()) {
+                diagnostics.append(chunk.diagnostics);
+                statements.insert(statements.end(), chunk.statements.begin(), chunk.statements.end());
+                i++;
+                continue;
+            }
+
+            diagnostics.append(chunk.diagnostics.all().first(chunk.last_diagnostics));
+            statements.insert(statements.end(), chunk.statements.begin(), chunk.statements.begin() + chunk.last_statements);
+
+            // the recovery of the error may go past the next chunks, the
+            // parse goes on until a statement ends where a chunk starts
+            TokenStream token_stream(*m_tokens, chunk.last_begin, eof);
+            Parser parser(token_stream, arena, diagnostics);
+
+            i++;
+            while (token_stream.peek().kind != TokenKind::Eof) {
+                while (i < chunks.size() && starts[i] < token_stream.position())
+                    i++;
+                if (i < chunks.size() && starts[i] == token_stream.position())
+                    break;
+
+                if (Ast::StatementPtr statement = parser.next())
+                    statements.push_back(statement);
+            }
+            if (token_stream.peek().kind == TokenKind::Eof)
+                i = chunks.size();
+        }
+
+        return statements;
+    }
+
+    std::vector<std::size_t> ParallelParser::boundaries(const TokenBuffer& tokens) {
+        std::span<const TokenKind> kinds = tokens.kinds();
+        std::vector<std::size_t> starts;
+
+        // the modifiers before a declaration belong to it
+        auto is_modifier = [](TokenKind kind) {
+            switch (kind) {
+                case TokenKind::KeyPub:
+                case TokenKind::KeyConst:
+                case TokenKind::KeyType:
+                case TokenKind::KeyStatic:
+                case TokenKind::KeyVolatile:
+                case TokenKind::KeyMut:
+                    return true;
+                default:
+                    return false;
+            }
+        };
+
+        // a stray closing bracket does not make the depth negative, an
+        // unbalanced file only gives less boundaries
+        std::size_t depth = 0;
+        TokenKind previous = TokenKind::Eof;
+        for (std::size_t i = 0; i + 1 < kinds.size(); previous = kinds[i], i++) {
+            TokenKind kind = kinds[i];
+            switch (kind) {
+                case TokenKind::Lpar:
+                case TokenKind::Lsbr:
+                case TokenKind::Lcbr:
+                    depth++;
+                    continue;
+                case TokenKind::Rpar:
+                case TokenKind::Rsbr:
+                case TokenKind::Rcbr:
+                    depth -= depth > 0;
+                    continue;
+                case TokenKind::KeyFn:
+                    break;
+                case TokenKind::Ident:
+                    // `a.b := 1` is not a declaration
+                    if (kinds[i + 1] != TokenKind::DeclAssign || previous == TokenKind::Dot)
+                        continue;
+                    break;
+                default:
+                    if (!is_modifier(kind))
+                        continue;
+                    break;
+            }
+
+            if (depth == 0 && !is_modifier(previous))
+                starts.push_back(i);
+        }
+
+        return starts;
+    }
+
+    std::size_t ParallelParser::threads() const {
+        if (m_options.pool != nullptr)
+            return m_options.pool->size();
+        return m_options.threads != 0 ? m_options.threads : std::thread::hardware_concurrency();
+    }
+
+    std::vector<std::size_t> ParallelParser::chunk_starts() const {
+        std::size_t size = m_tokens->size();
+        if (size < m_options.threshold || size <= 1)
+            return { 0 };
+
+        std::size_t count = std::min(std::max<std::size_t>(threads(), 1), size / std::max<std::size_t>(m_options.min_chunk_size, 1));
+        if (count <= 1)
+            return { 0 };
+
+        // every chunk starts at the first boundary after its share of the
+        // tokens, a chunk without boundary is merged with the previous one
+        std::vector<std::size_t> boundaries = ParallelParser::boundaries(*m_tokens);
+        std::vector<std::size_t> starts = { 0 };
+        for (std::size_t i = 1; i < count; i++) {
+            auto it = std::lower_bound(boundaries.begin(), boundaries.end(), size * i / count);
+            if (it != boundaries.end() && *it > starts.back())
+                starts.push_back(*it);
+        }
+
+        return starts;
+    }
+
+    void ParallelParser::parse_chunk(std::size_t begin, std::size_t end, Chunk& chunk) const {
+        TokenStream token_stream(*m_tokens, begin, end);
+        Parser parser(token_stream, chunk.arena, chunk.diagnostics);
+
+        while (token_stream.peek().kind != TokenKind::Eof) {
+            chunk.last_begin = token_stream.position();
+            chunk.last_statements = chunk.statements.size();
+            chunk.last_diagnostics = chunk.diagnostics.size();
+
+            Ast::StatementPtr statement = parser.next();
+            if (statement != nullptr)
+                chunk.statements.push_back(statement);
+
+            // the UTF-8 error belongs to the file, not to the statement
+            std::span<const Diagnostic> reported = chunk.diagnostics.all().subspan(chunk.last_diagnostics);
+            chunk.last_clean = statement != nullptr && std::all_of(reported.begin(), reported.end(), [](const Diagnostic& diagnostic) {
+                return diagnostic.type == ExceptionType::LexerInvalidUtf8;
+            });
+        }
+    }
+}
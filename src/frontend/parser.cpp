@@ -1,9 +1,13 @@
 #include <array>
-#include <codecvt>
 #include <cstddef>
-#include <memory>
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <vector>
 
+#include <diagnostics.hpp>
 #include <errors.hpp>
+#include <utils/utf8.hpp>
 #include <utils/utility.hpp>
 #include <frontend/ast/nodes.hpp>
 #include <frontend/lexer.hpp>
@@ -11,31 +15,173 @@
 #include <frontend/token_stream.hpp>
 
 namespace W {
-    static int get_token_precedence(TokenKind kind);
+    static constexpr int get_token_precedence(TokenKind kind) {
+        switch (kind) {
+            case TokenKind::LogicalOr: return 2;
+            case TokenKind::LogicalAnd: return 4;
+            case TokenKind::BitOr: return 6;
+            case TokenKind::BitXor: return 8;
+            case TokenKind::BitAnd: return 10;
+            case TokenKind::Lt: return 20;
+            case TokenKind::Le: return 20;
+            case TokenKind::Gt: return 20;
+            case TokenKind::Ge: return 20;
+            case TokenKind::Ne: return 20;
+            case TokenKind::Eq: return 20;
+            case TokenKind::LeftShift: return 30;
+            case TokenKind::RightShift: return 30;
+            case TokenKind::UnsignedRightShift: return 30;
+            case TokenKind::Plus: return 40;
+            case TokenKind::Minus: return 40;
+            case TokenKind::Mul: return 50;
+            case TokenKind::Div: return 50;
+            case TokenKind::Mod: return 50;
+
+            default: return -1;
+        }
+    }
+
+    static constexpr Ast::BinaryOp get_binary_op(TokenKind kind) {
+        switch (kind) {
+            case TokenKind::BitAnd: return Ast::BinaryOp::BitwiseAnd;
+            case TokenKind::BitOr: return Ast::BinaryOp::BitwiseOr;
+            case TokenKind::BitXor: return Ast::BinaryOp::BitwiseXor;
+            case TokenKind::Div: return Ast::BinaryOp::Divide;
+            case TokenKind::Eq: return Ast::BinaryOp::CompEq;
+            case TokenKind::Lt: return Ast::BinaryOp::CompLt;
+            case TokenKind::Le: return Ast::BinaryOp::CompLe;
+            case TokenKind::LogicalAnd: return Ast::BinaryOp::LogicalAnd;
+            case TokenKind::LogicalOr: return Ast::BinaryOp::LogicalOr;
+            case TokenKind::Gt: return Ast::BinaryOp::CompGt;
+            case TokenKind::Ge: return Ast::BinaryOp::CompGe;
+            case TokenKind::Mod: return Ast::BinaryOp::Modulo;
+            case TokenKind::Minus: return Ast::BinaryOp::Subtract;
+            case TokenKind::Mul: return Ast::BinaryOp::Multiply;
+            case TokenKind::Ne: return Ast::BinaryOp::CompNe;
+            case TokenKind::Plus: return Ast::BinaryOp::Add;
+            case TokenKind::LeftShift: return Ast::BinaryOp::ShiftLeft;
+            case TokenKind::RightShift: return Ast::BinaryOp::ShiftRight;
+            case TokenKind::UnsignedRightShift: return Ast::BinaryOp::UnsignedShiftRight;
+
+            // never read, the precedence of the token is -1
+            default: return Ast::BinaryOp::Add;
+        }
+    }
+
+    static bool get_unary_op(TokenKind kind, Ast::UnaryOp& op) {
+        switch (kind) {
+            case TokenKind::Plus: op = Ast::UnaryOp::Plus; return true;
+            case TokenKind::Minus: op = Ast::UnaryOp::Minus; return true;
+            case TokenKind::Mul: op = Ast::UnaryOp::Deref; return true;
+            case TokenKind::BitAnd: op = Ast::UnaryOp::Ref; return true;
+            case TokenKind::Not: op = Ast::UnaryOp::Not; return true;
+            case TokenKind::Question: op = Ast::UnaryOp::Option; return true;
+            default: return false;
+        }
+    }
+
+    static constexpr std::size_t s_token_kind_count = 0
+        #define WLANG_TOKEN(X) + 1
+        #include <frontend/token_list.hpp>
+        ;
+
+    struct BindingPower {
+        // -1 for a token which is not a binary operator
+        int8_t precedence;
+        Ast::BinaryOp op;
+    };
+
+    // indexed by TokenKind, it replaces two switches per token of an expression
+    static constexpr std::array<BindingPower, s_token_kind_count> s_binding_powers = [] {
+        std::array<BindingPower, s_token_kind_count> powers {};
+        for (std::size_t i = 0; i < s_token_kind_count; i++) {
+            TokenKind kind = static_cast<TokenKind>(i);
+            powers[i] = BindingPower { static_cast<int8_t>(get_token_precedence(kind)), get_binary_op(kind) };
+        }
+        return powers;
+    }();
+
+    // counts the nesting of expressions and functions, the only recursions
+    // of the parser, to report a too deep input instead of overflowing the
+    // stack
+    struct Parser::DepthGuard {
+        DepthGuard(Parser& parser):
+            m_parser(parser),
+            m_entered(parser.m_depth < s_max_depth)
+        {
+            if (m_entered) {
+                m_parser.m_depth++;
+            } else {
+                Token token = m_parser.m_token_stream.peek();
+                m_parser.m_diagnostics.report<ParserNestingTooDeepError>(m_parser.m_token_stream.location(token), s_max_depth);
+            }
+        }
 
-    Parser::Parser(TokenStream& token_stream):
-        m_token_stream(token_stream)
+        ~DepthGuard() {
+            if (m_entered)
+                m_parser.m_depth--;
+        }
+
+        // false when the limit is reached, the caller must fail
+        explicit operator bool() const {
+            return m_entered;
+        }
+
+        Parser& m_parser;
+        bool m_entered;
+    };
+
+    Parser::Parser(TokenStream& token_stream, utils::Arena& arena, Diagnostics& diagnostics):
+        Parser(token_stream, arena, diagnostics, Options())
     {}
 
+    Parser::Parser(TokenStream& token_stream, utils::Arena& arena, Diagnostics& diagnostics, Options options):
+        m_token_stream(token_stream),
+        m_arena(arena),
+        m_diagnostics(diagnostics),
+        m_options(options),
+        // a stream starting after the start of the file (a chunk of a
+        // ParallelParser) leaves the check to the one reading the start
+        m_checked_utf8(token_stream.position() != 0),
+        m_depth(0)
+    {}
+
+    template<typename T>
+    std::span<T> Parser::take(std::vector<T>& stack, std::size_t base) {
+        std::span<T> elements = m_arena.make_span(std::span<T>(stack).subspan(base));
+        stack.erase(stack.begin() + base, stack.end());
+        return elements;
+    }
+
     template<std::size_t N>
-    const Token& Parser::expected(std::array<TokenKind, N> kinds) {
-        const Token& token = m_token_stream.next();
+    bool Parser::expected(std::array<TokenKind, N> kinds, Token* result) {
+        Token token = m_token_stream.peek();
         
         for (auto it = kinds.begin(); it < kinds.end(); it++) {
-            if (token.kind == *it)
-                return token;
+            if (token.kind == *it) {
+                m_token_stream.next();
+                if (result != nullptr)
+                    *result = token;
+                return true;
+            }
         }
 
-        throw ParserUnexpectedTokenError(token.location, token.kind);
+        m_diagnostics.report<ParserUnexpectedTokenError>(m_token_stream.location(token), token.kind);
+        return false;
     }
 
-    const Token& Parser::expected(TokenKind kind) {
-        const Token& token = m_token_stream.next();
+    bool Parser::expected(TokenKind kind, Token* result) {
+        Token token = m_token_stream.peek();
         
-        if (token.kind != kind)
-            throw ParserExpectedTokenError(token.location, kind, token.kind);
+        if (token.kind != kind) {
+            m_diagnostics.report<ParserExpectedTokenError>(m_token_stream.location(token), kind, token.kind);
+            return false;
+        }
 
-        return token;
+        m_token_stream.next();
+        if (result != nullptr)
+            *result = token;
+        return true;
     }
 
     template<std::size_t N>
@@ -60,7 +206,120 @@ namespace W {
         return starting_by;
     }
 
+    bool Parser::starts_line(const Token& token) {
+        std::string_view source = m_token_stream.source();
+        for (uint32_t i = token.offset; i > 0; i--) {
+            char c = source[i - 1];
+            if (c == '\n')
+                return true;
+            if (c != ' ' && c != '\t' && c != '\r')
+                return false;
+        }
+
+        return true;
+    }
+
+    void Parser::synchronize(const Token& start) {
+        // the statement failed on its first token, it is skipped to make
+        // progress
+        if (m_token_stream.peek().offset == start.offset && start.kind != TokenKind::Eof)
+            m_token_stream.next();
+
+        // the brackets opened while skipping are skipped with their content
+        std::size_t depth = 0;
+        for (;;) {
+            Token token = m_token_stream.peek();
+            switch (token.kind) {
+                case TokenKind::Eof:
+                    return;
+                case TokenKind::KeyFn:
+                case TokenKind::KeyConst:
+                case TokenKind::KeyType:
+                case TokenKind::KeyPub:
+                case TokenKind::KeyMut:
+                case TokenKind::KeyStatic:
+                case TokenKind::KeyVolatile:
+                    if (depth == 0)
+                        return;
+                    break;
+                case TokenKind::Lpar:
+                case TokenKind::Lsbr:
+                case TokenKind::Lcbr:
+                    if (depth == 0 && starts_line(token))
+                        return;
+                    depth++;
+                    break;
+                case TokenKind::Rpar:
+                case TokenKind::Rsbr:
+                case TokenKind::Rcbr:
+                    // the end of the enclosing function body
+                    if (depth == 0 && token.kind == TokenKind::Rcbr)
+                        return;
+                    if (depth > 0)
+                        depth--;
+                    break;
+                default:
+                    // a new line after an expression starts a new statement
+                    if (depth == 0 && starts_line(token))
+                        return;
+                    break;
+            }
+
+            m_token_stream.next();
+        }
+    }
+
     Ast::StatementPtr Parser::next() {
+        // the file is validated when it is registered, the error is reported
+        // by the first statement
+        if (!m_checked_utf8) {
+            m_checked_utf8 = true;
+            FileId file = m_token_stream.file();
+            if (auto offset = SourceManager::global().file(file).invalid_utf8())
+                m_diagnostics.report<LexerInvalidUtf8Error>(Location { file, *offset, *offset + 1 });
+        }
+
+        // a failed statement leaves its pending children on the stacks
+        Token start = m_token_stream.peek();
+        std::size_t expressions_base = m_expressions.size();
+        std::size_t statements_base = m_statements.size();
+        std::size_t parameters_base = m_parameters.size();
+        std::size_t operators_base = m_operators.size();
+        std::size_t prefixes_base = m_prefixes.size();
+
+        Ast::StatementPtr stmt = parse_statement();
+        if (stmt == nullptr) {
+            m_expressions.resize(expressions_base);
+            m_statements.resize(statements_base);
+            m_parameters.erase(m_parameters.begin() + parameters_base, m_parameters.end());
+            m_operators.resize(operators_base);
+            m_prefixes.resize(prefixes_base);
+
+            synchronize(start);
+        }
+
+        return stmt;
+    }
+
+    void Parser::parse_body(Ast::DeclareFunctionStatement& function, utils::Arena& arena, Diagnostics& diagnostics) {
+        if (function.lazy_body == nullptr)
+            return;
+
+        TokenStream token_stream(*function.lazy_body->tokens, function.lazy_body->begin, function.lazy_body->end);
+        Parser parser(token_stream, arena, diagnostics);
+        // the statements are nested in the function
+        parser.m_depth = 1;
+
+        while (token_stream.peek().kind != TokenKind::Eof) {
+            if (Ast::StatementPtr stmt = parser.next())
+                parser.m_statements.push_back(stmt);
+        }
+
+        function.body = parser.take(parser.m_statements, 0);
+        function.lazy_body = nullptr;
+    }
+
+    Ast::StatementPtr Parser::parse_statement() {
         bool is_pub = start_by(TokenKind::KeyPub);
 
         TokenKind kind = m_token_stream.peek().kind;
@@ -79,7 +338,7 @@ namespace W {
                 break;
             }
             case TokenKind::Ident: {
-                const Token& next = m_token_stream.peek(1);
+                Token next = m_token_stream.peek(1);
 
                 if (next.kind == TokenKind::DeclAssign) {
                     stmt = parse_var_like_declaration();
@@ -87,14 +346,21 @@ namespace W {
                 }
             }
             default: {
-                auto expr_stmt = std::make_unique<Ast::ExpressionStatement>();
-                expr_stmt->expr = parse_expr();
-                expr_stmt->location = expr_stmt->expr->location;
+                Ast::ExpressionPtr expr = parse_expr();
+                if (expr == nullptr)
+                    return nullptr;
+
+                auto expr_stmt = m_arena.make<Ast::ExpressionStatement>();
+                expr_stmt->expr = expr;
+                expr_stmt->location = expr->location;
 
-                stmt = std::move(expr_stmt);
+                stmt = expr_stmt;
             }
         }
-        
+
+        if (stmt == nullptr)
+            return nullptr;
+
         stmt->is_pub = is_pub;
         return stmt;
     }
@@ -103,54 +369,89 @@ namespace W {
         using FuncParam = Ast::DeclareFunctionStatement::Parameter;
         using VarMod = Ast::VariableModifiers;
 
-        auto declare_func = std::make_unique<Ast::DeclareFunctionStatement>();
-        Location start_location = expected(TokenKind::KeyFn).location;
-        
-        declare_func->name = expected(TokenKind::Ident).raw;
+        DepthGuard guard(*this);
+        if (!guard)
+            return nullptr;
+
+        Token fn_token, name_token;
+        if (!expected(TokenKind::KeyFn, &fn_token) || !expected(TokenKind::Ident, &name_token))
+            return nullptr;
+
+        auto declare_func = m_arena.make<Ast::DeclareFunctionStatement>();
+        Location start_location = m_token_stream.location(fn_token);
+        declare_func->name = name_token.symbol();
         
         // parse the function input
-        expected(TokenKind::Lpar);
-        const Token* token = &m_token_stream.peek();
-        while (token->kind != TokenKind::Rpar && token->kind != TokenKind::Eof) {
-            Location start_param_location = m_token_stream.peek().location;
+        std::size_t parameters_base = m_parameters.size();
+        if (!expected(TokenKind::Lpar))
+            return nullptr;
+
+        Token token = m_token_stream.peek();
+        while (token.kind != TokenKind::Rpar && token.kind != TokenKind::Eof) {
+            Location start_param_location = m_token_stream.location(m_token_stream.peek());
             
-            VarMod modifiers;
+            VarMod modifiers = VarMod::None;
             if (start_by(TokenKind::KeyVolatile))
                 modifiers |= VarMod::Volatile;
             if (start_by(TokenKind::KeyMut))
                 modifiers |= VarMod::Mutable;
             
-            std::string name = expected(TokenKind::Ident).raw;
+            Token param_name;
+            if (!expected(TokenKind::Ident, &param_name))
+                return nullptr;
 
             auto type = parse_expr();
-            declare_func->parameters.push_back(FuncParam {
-                .location = Location::merge(start_location, type->location),
+            if (type == nullptr)
+                return nullptr;
+
+            m_parameters.push_back(FuncParam {
+                .location = Location::merge(start_param_location, type->location),
                 .modifiers = modifiers,
-                .name = std::move(name),
-                .type = std::move(type),
+                .name = param_name.symbol(),
+                .type = type,
             });
 
             if (!start_by(TokenKind::Comma))
                 break;
 
-            token = &m_token_stream.peek();
+            token = m_token_stream.peek();
         }
-        expected(TokenKind::Rpar);
+        if (!expected(TokenKind::Rpar))
+            return nullptr;
+        declare_func->parameters = take(m_parameters, parameters_base);
 
         // parse the function body and the return type if it exists
         if (!start_by(TokenKind::Lcbr)) {
-            declare_func->return_type = parse_expr();
-            expected(TokenKind::Lcbr);
+            Ast::ExpressionPtr return_type = parse_expr();
+            if (return_type == nullptr || !expected(TokenKind::Lcbr))
+                return nullptr;
+            declare_func->return_type = return_type;
+        }
+
+        // a lazy body is only scanned for its closing brace
+        if (m_options.lazy_bodies && m_token_stream.buffer() != nullptr) {
+            std::size_t begin = m_token_stream.position();
+            std::size_t end = m_token_stream.matching(TokenKind::Lcbr, TokenKind::Rcbr);
+            m_token_stream.seek(end);
+
+            declare_func->lazy_body = m_arena.make<Ast::LazyBody>(m_token_stream.buffer(), static_cast<uint32_t>(begin), static_cast<uint32_t>(end));
         }
 
-        token = &m_token_stream.peek();
-        while (token->kind != TokenKind::Rcbr && token->kind != TokenKind::Eof) {
-            declare_func->body.push_back(next());
-            token = &m_token_stream.peek();
+        // a failed statement of the body is reported and skipped
+        std::size_t body_base = m_statements.size();
+        token = m_token_stream.peek();
+        while (token.kind != TokenKind::Rcbr && token.kind != TokenKind::Eof) {
+            if (Ast::StatementPtr stmt = next())
+                m_statements.push_back(stmt);
+            token = m_token_stream.peek();
         }
-        Location end_location = expected(TokenKind::Rcbr).location;
+        declare_func->body = take(m_statements, body_base);
 
-        declare_func->location = Location::merge(start_location, end_location);
+        Token end_token;
+        if (!expected(TokenKind::Rcbr, &end_token))
+            return nullptr;
+
+        declare_func->location = Location::merge(start_location, m_token_stream.location(end_token));
 
         return declare_func;
     }
@@ -158,11 +459,11 @@ namespace W {
     Ast::StatementPtr Parser::parse_var_like_declaration() {
         using VarMod = Ast::VariableModifiers;
 
-        const Token* modifier_token = &m_token_stream.peek();
-        Location start_location = modifier_token->location;
+        Token modifier_token = m_token_stream.peek();
+        Location start_location = m_token_stream.location(modifier_token);
 
         VarMod modifiers;
-        switch (modifier_token->kind) {
+        switch (modifier_token.kind) {
             case TokenKind::KeyConst: modifiers = VarMod::Const; break;
             case TokenKind::KeyType: modifiers = VarMod::Type; break;
             case TokenKind::KeyStatic: modifiers = VarMod::Static; break;
@@ -171,37 +472,41 @@ namespace W {
         
         if (modifiers != VarMod::None) {
             m_token_stream.next();
-            modifier_token = &m_token_stream.peek();
+            modifier_token = m_token_stream.peek();
         }
         
-        if(modifier_token->kind == TokenKind::KeyVolatile) {
+        if(modifier_token.kind == TokenKind::KeyVolatile) {
             modifiers |= VarMod::Volatile;
             m_token_stream.next();
-            modifier_token = &m_token_stream.peek();
+            modifier_token = m_token_stream.peek();
         }
 
-        if(modifier_token->kind == TokenKind::KeyMut) {
+        if(modifier_token.kind == TokenKind::KeyMut) {
+            // the declaration is still parsed, the modifier is ignored
             if ((modifiers & VarMod::Const) != VarMod::None)
-                throw ParserUnexpectedConstMutabilityError(modifier_token->location);
+                m_diagnostics.report<ParserUnexpectedConstMutabilityError>(m_token_stream.location(modifier_token));
             else if ((modifiers & VarMod::Type) != VarMod::None)
-                throw ParserUnexpectedTypeMutabilityError(modifier_token->location);
-                
-            modifiers |= VarMod::Mutable;
+                m_diagnostics.report<ParserUnexpectedTypeMutabilityError>(m_token_stream.location(modifier_token));
+            else
+                modifiers |= VarMod::Mutable;
+
             m_token_stream.next();
-            modifier_token = &m_token_stream.peek();
+            modifier_token = m_token_stream.peek();
         }
 
-        const Token& name_token = expected(TokenKind::Ident);
-
-        expected(TokenKind::DeclAssign);
+        Token name_token;
+        if (!expected(TokenKind::Ident, &name_token) || !expected(TokenKind::DeclAssign))
+            return nullptr;
 
         Ast::ExpressionPtr value = parse_expr();
+        if (value == nullptr)
+            return nullptr;
 
-        auto declare_var = std::make_unique<Ast::DeclareVariableStatement>();
+        auto declare_var = m_arena.make<Ast::DeclareVariableStatement>();
         declare_var->modifiers = modifiers;
-        declare_var->name = std::move(name_token.raw);
+        declare_var->name = name_token.symbol();
         declare_var->location = Location::merge(start_location, value->location);
-        declare_var->value = std::move(value);
+        declare_var->value = value;
 
         return declare_var;
     }
@@ -212,148 +517,162 @@ namespace W {
     // Ast::StatementPtr Parser::parse_defer();
 
     Ast::ExpressionPtr Parser::parse_expr(int precedence) {
-        return parse_binary(precedence, parse_unary());
-    }
-
-    Ast::ExpressionPtr Parser::parse_binary(int precedence, Ast::ExpressionPtr lhs) {
-        const Token& curr_op = m_token_stream.peek();
-
-        int op_precedence = get_token_precedence(curr_op.kind);
-        if (op_precedence < precedence)
-            return lhs;
+        DepthGuard guard(*this);
+        if (!guard)
+            return nullptr;
+
+        // the left operands and the operators waiting for their right operand,
+        // the top of the stacks belongs to this call
+        std::size_t base = m_operators.size();
+
+        Ast::ExpressionPtr lhs = parse_unary();
+        for (;;) {
+            // the pending operands are dropped by the failed statement
+            if (lhs == nullptr)
+                return nullptr;
+
+            Token op = m_token_stream.peek();
+            BindingPower power = s_binding_powers[static_cast<std::size_t>(op.kind)];
+
+            // the operators are left associative, a pending operator which
+            // binds at least as tight takes lhs as its right operand
+            while (m_operators.size() > base && s_binding_powers[static_cast<std::size_t>(m_operators.back().kind)].precedence >= power.precedence) {
+                Ast::BinaryExpression* binary_expr = m_arena.make<Ast::BinaryExpression>();
+                binary_expr->op = s_binding_powers[static_cast<std::size_t>(m_operators.back().kind)].op;
+                binary_expr->left = m_expressions.back();
+                binary_expr->right = lhs;
+                binary_expr->location = Location::merge(binary_expr->left->location, lhs->location);
+
+                m_operators.pop_back();
+                m_expressions.pop_back();
+                lhs = binary_expr;
+            }
 
-        m_token_stream.next();
+            // not an operator (-1) ends the expression, it is the start of
+            // the next statement or expression
+            if (power.precedence < precedence)
+                return lhs;
 
-        Ast::ExpressionPtr rhs = parse_unary();
-
-        const Token& next_op = m_token_stream.peek();
-
-        int next_op_precedence = get_token_precedence(next_op.kind);
-        if (op_precedence < next_op_precedence)
-            rhs = parse_binary(precedence, std::move(rhs));
-
-        Ast::BinaryOp bin_op;
-        switch (curr_op.kind) {
-            case TokenKind::BitAnd: bin_op = Ast::BinaryOp::BitwiseAnd; break;
-            case TokenKind::BitOr: bin_op = Ast::BinaryOp::BitwiseOr; break;
-            case TokenKind::BitXor: bin_op = Ast::BinaryOp::BitwiseXor; break;
-            case TokenKind::Div: bin_op = Ast::BinaryOp::Divide; break;
-            case TokenKind::Eq: bin_op = Ast::BinaryOp::CompEq; break;
-            case TokenKind::Lt: bin_op = Ast::BinaryOp::CompLt; break;
-            case TokenKind::Le: bin_op = Ast::BinaryOp::CompLe; break;
-            case TokenKind::LogicalAnd: bin_op = Ast::BinaryOp::LogicalAnd; break;
-            case TokenKind::LogicalOr: bin_op = Ast::BinaryOp::LogicalOr; break;
-            case TokenKind::Gt: bin_op = Ast::BinaryOp::CompGt; break;
-            case TokenKind::Ge: bin_op = Ast::BinaryOp::CompGe; break;
-            case TokenKind::Mod: bin_op = Ast::BinaryOp::Modulo; break;
-            case TokenKind::Minus: bin_op = Ast::BinaryOp::Subtract; break;
-            case TokenKind::Mul: bin_op = Ast::BinaryOp::Multiply; break;
-            case TokenKind::Ne: bin_op = Ast::BinaryOp::CompNe; break;
-            case TokenKind::Plus: bin_op = Ast::BinaryOp::Add; break;
-            case TokenKind::LeftShift: bin_op = Ast::BinaryOp::ShiftLeft; break;
-            case TokenKind::RightShift: bin_op = Ast::BinaryOp::ShiftRight; break;
-            case TokenKind::UnsignedRightShift: bin_op = Ast::BinaryOp::UnsignedShiftRight; break;
-
-            // is not a symbol of the current expression (it will be considered as a new statement or expression)
-            default: return lhs;
-        }
-
-        auto binary_expr = std::make_unique<Ast::BinaryExpression>();
-        binary_expr->location = Location::merge(lhs->location, rhs->location);
-        binary_expr->left = std::move(lhs);
-        binary_expr->right = std::move(rhs);
-        binary_expr->op = bin_op;
-
-        return parse_binary(precedence, std::move(binary_expr));
+            m_token_stream.next();
+            m_operators.push_back(op);
+            m_expressions.push_back(lhs);
+            lhs = parse_unary();
+        }
     }
 
     Ast::ExpressionPtr Parser::parse_unary() {
-        const Token& token = m_token_stream.peek();
-        Ast::ExpressionPtr final_expr;
-        Ast::ExpressionPtr* base;
-
-        if (token.kind == TokenKind::Lsbr) {
-            expected(TokenKind::Lsbr);
-            if (start_by(TokenKind::Rsbr)) {
-                auto type_expr = std::make_unique<Ast::SliceTypeExpression>();
-                
-                base = &type_expr->inner_type;
-                final_expr = std::move(type_expr);
-            } else {
-                auto type_expr = std::make_unique<Ast::ArrayTypeExpression>();
+        // the prefixes are applied from the innermost once the operand is parsed
+        std::size_t base = m_prefixes.size();
+
+        for (;;) {
+            Token token = m_token_stream.peek();
+            if (token.kind == TokenKind::Lsbr) {
+                m_token_stream.next();
+
+                // `[]T` is a slice, `[length]T` an array
+                Ast::ExpressionPtr length = nullptr;
+                if (!start_by(TokenKind::Rsbr)) {
+                    length = parse_expr();
+                    if (length == nullptr || !expected(TokenKind::Rsbr))
+                        return nullptr;
+                }
+
+                m_prefixes.push_back(Prefix { token, Ast::UnaryOp::Plus, length });
+                continue;
+            }
 
-                type_expr->lenght = parse_expr();
-                expected(TokenKind::Rsbr);
+            // reported then ignored, the operand is still parsed
+            if (token.kind == TokenKind::Inc || token.kind == TokenKind::Dec) {
+                if (token.kind == TokenKind::Inc)
+                    m_diagnostics.report<ParserUnsupportedPrefixIncError>(m_token_stream.location(token));
+                else
+                    m_diagnostics.report<ParserUnsupportedPrefixDecError>(m_token_stream.location(token));
 
-                base = &type_expr->inner_type;
-                final_expr = std::move(type_expr);
+                m_token_stream.next();
+                continue;
             }
-        } else {
+
             Ast::UnaryOp op;
-            switch (token.kind) {
-                case TokenKind::Plus: op = Ast::UnaryOp::Plus; break;
-                case TokenKind::Minus: op = Ast::UnaryOp::Minus; break;
-                case TokenKind::Mul: op = Ast::UnaryOp::Deref; break;
-                case TokenKind::BitAnd: op = Ast::UnaryOp::Ref; break;
-                case TokenKind::Not: op = Ast::UnaryOp::Not; break;
-                case TokenKind::Question: op = Ast::UnaryOp::Option; break;
-                
-                case TokenKind::Inc: throw ParserUnsupportedPrefixIncError(token.location);
-                case TokenKind::Dec: throw ParserUnsupportedPrefixDecError(token.location);
-    
-                default:
-                    return parse_access(parse_primitive());
-            }
+            if (!get_unary_op(token.kind, op))
+                break;
+
             m_token_stream.next();
+            m_prefixes.push_back(Prefix { token, op, nullptr });
+        }
 
-            auto unary_expr = std::make_unique<Ast::UnaryExpression>();
-            unary_expr->op = op;
+        Ast::ExpressionPtr expr = parse_primitive();
+        if (expr != nullptr)
+            expr = parse_access(expr);
+        if (expr == nullptr)
+            return nullptr;
+
+        while (m_prefixes.size() > base) {
+            Prefix prefix = m_prefixes.back();
+            m_prefixes.pop_back();
+
+            Ast::ExpressionPtr final_expr;
+            if (prefix.token.kind != TokenKind::Lsbr) {
+                auto unary_expr = m_arena.make<Ast::UnaryExpression>();
+                unary_expr->op = prefix.op;
+                unary_expr->expr = expr;
+                final_expr = unary_expr;
+            } else if (prefix.length == nullptr) {
+                auto type_expr = m_arena.make<Ast::SliceTypeExpression>();
+                type_expr->inner_type = expr;
+                final_expr = type_expr;
+            } else {
+                auto type_expr = m_arena.make<Ast::ArrayTypeExpression>();
+                type_expr->lenght = prefix.length;
+                type_expr->inner_type = expr;
+                final_expr = type_expr;
+            }
 
-            base = &unary_expr->expr;
-            final_expr = std::move(unary_expr);
+            final_expr->location = Location::merge(m_token_stream.location(prefix.token), expr->location);
+            expr = final_expr;
         }
-        
-        *base = parse_unary();
-        final_expr->location = Location::merge(token.location, (*base)->location);
 
-        return final_expr;
+        return expr;
     }
 
     Ast::ExpressionPtr Parser::parse_access(Ast::ExpressionPtr member) {
-        const Token& token = m_token_stream.peek();
-        if (token.kind == TokenKind::Dot) {
-            expected(TokenKind::Dot);
+        for (;;) {
+            Token token = m_token_stream.peek();
+            if (token.kind == TokenKind::Dot) {
+                std::size_t base = m_expressions.size();
+                m_expressions.push_back(member);
+                while (start_by(TokenKind::Dot)) {
+                    Ast::ExpressionPtr next_member = parse_primitive();
+                    if (next_member == nullptr)
+                        return nullptr;
+                    m_expressions.push_back(next_member);
+                }
 
-            if (member->get_type() == Ast::NodeType::AccessIdentifierExpression) {
-                auto access_identifier = static_cast<Ast::AccessIdentifierExpression*>(member.get());
-                access_identifier->members.push_back(parse_primitive());
+                auto access_identifier = m_arena.make<Ast::AccessIdentifierExpression>();
+                access_identifier->location = Location::merge(member->location, m_expressions.back()->location);
+                access_identifier->members = take(m_expressions, base);
 
-                return parse_access(std::move(member));
-            } else {
-                auto access_identifier = std::make_unique<Ast::AccessIdentifierExpression>();
-                access_identifier->members.push_back(std::move(member));
+                member = access_identifier;
+            } else if (token.kind == TokenKind::Lpar || token.kind == TokenKind::Lsbr) {
+                m_token_stream.next();
 
-                return parse_access(std::move(access_identifier));
-            }
-        }
+                Location end_location;
+                std::optional<std::span<Ast::ExpressionPtr>> params = parse_expr_list(
+                    token.kind == TokenKind::Lpar ? TokenKind::Rpar : TokenKind::Rsbr,
+                    &end_location
+                );
+                if (!params)
+                    return nullptr;
 
-        if (token.kind == TokenKind::Lpar || token.kind == TokenKind::Lsbr) {
-            expected(std::array { TokenKind::Lpar, TokenKind::Lsbr });
+                auto call_expr = m_arena.make<Ast::CallExpression>();
+                call_expr->location = Location::merge(member->location, end_location);
+                call_expr->callee = member;
+                call_expr->params = *params;
 
-            Location end_location;
-            std::vector<Ast::ExpressionPtr> params = parse_expr_list(
-                token.kind == TokenKind::Lpar ? TokenKind::Rpar : TokenKind::Rsbr,
-                &end_location
-            );
-
-            auto call_expr = std::make_unique<Ast::CallExpression>();
-            call_expr->callee = std::move(member);
-            call_expr->params = std::move(params);
-
-            return parse_access(std::move(call_expr));
+                member = call_expr;
+            } else {
+                return member;
+            }
         }
-
-        return member;
     }
 
     Ast::ExpressionPtr Parser::parse_primitive() {
@@ -381,136 +700,162 @@ namespace W {
                 return parse_enum_variant();
             }
             case TokenKind::Lpar: {
-                Location start_location = expected(TokenKind::Lpar).location;
-                auto parent_expr = std::make_unique<Ast::ParentExpression>();
-                parent_expr->expr = parse_expr();
-                parent_expr->location = Location::merge(start_location, expected(TokenKind::Rpar).location);
+                Location start_location = m_token_stream.location(m_token_stream.next());
+
+                Ast::ExpressionPtr expr = parse_expr();
+                Token end_token;
+                if (expr == nullptr || !expected(TokenKind::Rpar, &end_token))
+                    return nullptr;
+
+                auto parent_expr = m_arena.make<Ast::ParentExpression>();
+                parent_expr->expr = expr;
+                parent_expr->location = Location::merge(start_location, m_token_stream.location(end_token));
                 return parent_expr;
             }
             default: {
-                utils::unreachable();
+                Token token = m_token_stream.peek();
+                // the lexer makes an unknown token of a string running to
+                // the end of the file
+                char first = token.kind == TokenKind::Unknown ? m_token_stream.source()[token.offset] : 0;
+                if (first == '"' || first == '\'' || first == '`')
+                    m_diagnostics.report<LexerUnterminatedStringError>(m_token_stream.location(token));
+                else
+                    m_diagnostics.report<ParserUnexpectedTokenError>(m_token_stream.location(token), token.kind);
+                return nullptr;
             }
         }
     }
 
+    // the literals below are called once the kind of the next token is
+    // known, their errors are reported without failing the expression
+
     Ast::ExpressionPtr Parser::parse_bool() {
-        const Token& token = expected(std::array { TokenKind::KeyTrue, TokenKind::KeyFalse });
-        auto lit = std::make_unique<Ast::BoolLiteral>();
+        Token token = m_token_stream.next();
+        auto lit = m_arena.make<Ast::BoolLiteral>();
         lit->value = token.kind == TokenKind::KeyTrue ? true : false;
-        lit->location = token.location;
+        lit->location = m_token_stream.location(token);
 
         return lit;
     }
 
+    bool Parser::check_literal(const Token& token) {
+        switch (token.literal()) {
+            case LiteralId::OutOfRange:
+                m_diagnostics.report<LexerLiteralOutOfRangeError>(m_token_stream.location(token), std::string(m_token_stream.raw(token)));
+                return false;
+            case LiteralId::Invalid:
+                m_diagnostics.report<LexerInvalidLiteralError>(m_token_stream.location(token), std::string(m_token_stream.raw(token)));
+                return false;
+            default:
+                return true;
+        }
+    }
+
+    std::string_view Parser::string_literal(const Token& token) {
+        std::string_view raw = m_token_stream.raw(token);
+        if (token.literal() == LiteralId::Invalid) {
+            m_diagnostics.report<LexerInvalidEscapeError>(m_token_stream.location(token), std::string(raw));
+            return raw;
+        }
+
+        return LiteralTable::global().string(token.literal(), raw);
+    }
+
     Ast::ExpressionPtr Parser::parse_int() {
-        const Token& token = expected(TokenKind::Integer);
-        auto lit = std::make_unique<Ast::IntLiteral>();
-        lit->value = std::stol(token.raw);
-        lit->location = token.location;
+        Token token = m_token_stream.next();
+        auto lit = m_arena.make<Ast::IntLiteral>();
+        lit->value = check_literal(token) ? static_cast<int64_t>(LiteralTable::global().integer(token.literal())) : 0;
+        lit->location = m_token_stream.location(token);
 
         return lit;
     }
 
     Ast::ExpressionPtr Parser::parse_float() {
-        const Token& token = expected(TokenKind::Float);
-        auto lit = std::make_unique<Ast::FloatLiteral>();
-        lit->value = std::stod(token.raw);
-        lit->raw = std::move(token.raw);
-        lit->location = token.location;
+        Token token = m_token_stream.next();
+        auto lit = m_arena.make<Ast::FloatLiteral>();
+        std::string_view raw = m_token_stream.raw(token);
+        lit->value = check_literal(token) ? LiteralTable::global().floating(token.literal()) : 0;
+        lit->raw = raw;
+        lit->location = m_token_stream.location(token);
 
         return lit;
     }
     
     Ast::ExpressionPtr Parser::parse_rune() {
-        static std::wstring_convert<std::codecvt_utf8<char32_t>, char32_t> utf8_codec;
-        
-        const Token& token = expected(TokenKind::Rune);
-        try {
-            auto rune = utf8_codec.from_bytes(token.raw);
-            if (rune.empty())
-                throw ParserEmptyRuneError(token.location);
-            
-            if (rune.length() > 1)
-                throw ParserRuneIsNotAStringError(token.location, std::move(token.raw));
-            
-            auto lit = std::make_unique<Ast::RuneLiteral>();
-            lit->value = rune[0];
-            lit->location = token.location;
-            
+        Token token = m_token_stream.next();
+        auto lit = m_arena.make<Ast::RuneLiteral>();
+        lit->value = 0;
+        lit->location = m_token_stream.location(token);
+
+        std::string_view raw = string_literal(token);
+        if (raw.empty()) {
+            m_diagnostics.report<ParserEmptyRuneError>(m_token_stream.location(token));
             return lit;
-        } catch (std::range_error const&) {
-            throw ParserIllFormedRuneError(token.location, std::move(token.raw));
         }
+
+        // the source is valid UTF-8 but a \x escape may not be
+        char32_t rune;
+        std::size_t length = utils::decode_utf8(raw, rune);
+        if (length == 0)
+            m_diagnostics.report<ParserIllFormedRuneError>(m_token_stream.location(token), std::string(raw));
+        else if (length != raw.size())
+            m_diagnostics.report<ParserRuneIsNotAStringError>(m_token_stream.location(token), std::string(raw));
+        else
+            lit->value = rune;
+
+        return lit;
     }
 
     Ast::ExpressionPtr Parser::parse_string() {
-        const Token& token = expected(TokenKind::String);
-        auto lit = std::make_unique<Ast::StringLiteral>();
-        lit->value = std::move(token.raw);
-        lit->location = token.location;
+        Token token = m_token_stream.next();
+        auto lit = m_arena.make<Ast::StringLiteral>();
+        lit->value = string_literal(token);
+        lit->location = m_token_stream.location(token);
         
         return lit;
     }
     
     Ast::ExpressionPtr Parser::parse_ident() {
-        const Token& token = expected(TokenKind::Ident);
-        auto lit = std::make_unique<Ast::IdentExpression>();
-        lit->value = std::move(token.raw);
-        lit->location = token.location;
+        Token token = m_token_stream.next();
+        auto lit = m_arena.make<Ast::IdentExpression>();
+        lit->value = token.symbol();
+        lit->location = m_token_stream.location(token);
 
         return lit;
     }
     
     Ast::ExpressionPtr Parser::parse_enum_variant() {
-        Location dot = expected(TokenKind::Dot).location;
-        const Token& token = expected(TokenKind::Ident);
-        auto lit = std::make_unique<Ast::EnumVariantLiteral>();
-        lit->value = std::move(token.raw);
-        lit->location = Location::merge(dot, token.location);
+        Location dot = m_token_stream.location(m_token_stream.next());
+        Token token;
+        if (!expected(TokenKind::Ident, &token))
+            return nullptr;
+
+        auto lit = m_arena.make<Ast::EnumVariantLiteral>();
+        lit->value = token.symbol();
+        lit->location = Location::merge(dot, m_token_stream.location(token));
 
         return lit;
     }
 
-    std::vector<Ast::ExpressionPtr> Parser::parse_expr_list(TokenKind termination_token, Location* termination_location) {
-        std::vector<Ast::ExpressionPtr> parameters;
+    std::optional<std::span<Ast::ExpressionPtr>> Parser::parse_expr_list(TokenKind termination_token, Location* termination_location) {
+        std::size_t base = m_expressions.size();
 
         while (m_token_stream.peek().kind != termination_token) {
-            parameters.push_back(parse_expr());
+            Ast::ExpressionPtr expr = parse_expr();
+            if (expr == nullptr)
+                return std::nullopt;
+            m_expressions.push_back(expr);
                 
-            if (m_token_stream.peek().kind != TokenKind::Comma)
+            if (!start_by(TokenKind::Comma))
                 break;
-            expected(TokenKind::Comma);
         }
 
-        const Token& token = expected(termination_token);
-        if (termination_location == nullptr)
-            *termination_location = token.location;
-
-        return parameters;
-    }
-
-    static int get_token_precedence(TokenKind kind) {
-        switch (kind) {
-            case TokenKind::LogicalOr: return 2;
-            case TokenKind::LogicalAnd: return 4;
-            case TokenKind::BitOr: return 6;
-            case TokenKind::BitXor: return 8;
-            case TokenKind::BitAnd: return 10;
-            case TokenKind::Lt: return 20;
-            case TokenKind::Le: return 20;
-            case TokenKind::Gt: return 20;
-            case TokenKind::Ge: return 20;
-            case TokenKind::Ne: return 20;
-            case TokenKind::Eq: return 20;
-            case TokenKind::LeftShift: return 30;
-            case TokenKind::RightShift: return 30;
-            case TokenKind::Plus: return 40;
-            case TokenKind::Minus: return 40;
-            case TokenKind::Mul: return 50;
-            case TokenKind::Div: return 50;
-            case TokenKind::Mod: return 50;
+        Token token;
+        if (!expected(termination_token, &token))
+            return std::nullopt;
+        if (termination_location != nullptr)
+            *termination_location = m_token_stream.location(token);
 
-            default: return -1;
-        }
+        return take(m_expressions, base);
     }
 }
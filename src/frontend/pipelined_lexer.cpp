@@ -0,0 +1,75 @@
+#include <frontend/lexer.hpp>
+#include <frontend/pipelined_lexer.hpp>
+
+namespace W {
+    PipelinedLexer::PipelinedLexer(FileId file):
+        m_file(file),
+        // started last, every member it uses is initialized
+        m_thread(&PipelinedLexer::produce, this)
+    {}
+
+    PipelinedLexer::~PipelinedLexer() {
+        m_stop.store(true, std::memory_order_relaxed);
+
+        // the lexer thread may be waiting for a free slot, the batches are
+        // drained until its last one
+        while (!m_finished) {
+            if (m_batch != nullptr)
+                m_ring.release();
+            m_batch = &m_ring.wait_published_slot();
+            m_finished = m_batch->last;
+        }
+        m_ring.release();
+
+        m_thread.join();
+    }
+
+    void PipelinedLexer::produce() {
+        Lexer lexer(m_file);
+        bool done = false;
+
+        while (!done) {
+            Batch& batch = m_ring.wait_free_slot();
+            batch.size = 0;
+
+            try {
+                while (batch.size < s_batch_size) {
+                    Token token = lexer.next();
+                    batch.tokens[batch.size++] = token;
+                    if (token.kind == TokenKind::Eof) {
+                        done = true;
+                        break;
+                    }
+                }
+            } catch (...) {
+                // published with the last batch
+                m_error = std::current_exception();
+                done = true;
+            }
+
+            done |= m_stop.load(std::memory_order_relaxed);
+            batch.last = done;
+            m_ring.publish();
+        }
+    }
+
+    Token PipelinedLexer::next_batch() {
+        while (!m_finished) {
+            if (m_batch != nullptr)
+                m_ring.release();
+
+            m_batch = &m_ring.wait_published_slot();
+            m_read = 0;
+            m_finished = m_batch->last;
+
+            if (m_batch->size > 0) {
+                m_eof = m_batch->tokens[m_batch->size - 1];
+                return m_batch->tokens[m_read++];
+            }
+        }
+
+        if (m_error)
+            std::rethrow_exception(m_error);
+        return m_eof;
+    }
+}
@@ -0,0 +1,452 @@
+#include <cstdint>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define W_SCANNERS_X86 1
+#endif
+
+#include <frontend/scanners.hpp>
+#include <utils/utf8.hpp>
+
+namespace W::Scanners {
+    static inline bool is_whitespace(unsigned char c) {
+        return c == ' ' || static_cast<unsigned char>(c - '\t') <= '\r' - '\t';
+    }
+
+    static inline bool is_ident(unsigned char c) {
+        return static_cast<unsigned char>((c | 0x20) - 'a') <= 'z' - 'a'
+            || static_cast<unsigned char>(c - '0') <= 9
+            || c == '_';
+    }
+
+    static inline bool is_line_end(unsigned char c) {
+        return c == '\n' || c == 0;
+    }
+
+    static inline bool is_comment_delimiter(unsigned char c) {
+        return c == '*' || c == '/' || c == 0;
+    }
+
+    static inline bool is_string_delimiter(unsigned char c) {
+        return c == '"' || c == '\'' || c == '`' || c == '\\' || c == 0;
+    }
+
+    // SCALAR
+
+    template<bool (*InRun)(unsigned char)>
+    static const char* scalar_skip(const char* begin, const char* end) {
+        while (begin < end && InRun(static_cast<unsigned char>(*begin)))
+            begin++;
+        return begin;
+    }
+
+    template<bool (*Stop)(unsigned char)>
+    static const char* scalar_find(const char* begin, const char* end) {
+        while (begin < end && !Stop(static_cast<unsigned char>(*begin)))
+            begin++;
+        return begin;
+    }
+
+    static void scalar_collect_line_starts(const char* begin, const char* end, std::vector<uint32_t>& starts, const char* origin) {
+        for (const char* it = begin; it < end; it++) {
+            if (*it == '\n')
+                starts.push_back(static_cast<uint32_t>(it - origin + 1));
+        }
+    }
+
+    static void scalar_collect_line_starts(const char* begin, const char* end, std::vector<uint32_t>& starts) {
+        scalar_collect_line_starts(begin, end, starts, begin);
+    }
+
+    static const char* scalar_validate_utf8(const char* begin, const char* end) {
+        while (begin < end) {
+            // 8 ascii bytes at once
+            uint64_t word;
+            if (end - begin >= 8 && (std::memcpy(&word, begin, 8), (word & 0x8080808080808080) == 0)) {
+                begin += 8;
+                continue;
+            }
+
+            char32_t code_point;
+            std::size_t length = utils::decode_utf8(std::string_view(begin, end - begin), code_point);
+            if (length == 0)
+                return begin;
+            begin += length;
+        }
+        return begin;
+    }
+
+    static const Table s_scalar = {
+        .skip_whitespace = scalar_skip<is_whitespace>,
+        .skip_ident = scalar_skip<is_ident>,
+        .find_line_end = scalar_find<is_line_end>,
+        .find_comment_delimiter = scalar_find<is_comment_delimiter>,
+        .find_string_delimiter = scalar_find<is_string_delimiter>,
+        .validate_utf8 = scalar_validate_utf8,
+        .collect_line_starts = scalar_collect_line_starts,
+    };
+
+#if defined(W_SCANNERS_X86)
+    // each matcher returns a byte mask, 0xff for the bytes of the vector which
+    // stop the scan; the block loops are shared by every scanner and only the
+    // tail (less than one vector) goes through the scalar path
+
+    // SSE2
+
+    static inline __m128i sse2_in_range(__m128i v, char low, char high) {
+        // unsigned (v - low) <= (high - low)
+        __m128i shifted = _mm_sub_epi8(v, _mm_set1_epi8(low));
+        __m128i limit = _mm_set1_epi8(static_cast<char>(high - low));
+        return _mm_cmpeq_epi8(_mm_min_epu8(shifted, limit), shifted);
+    }
+
+    static inline __m128i sse2_stop_whitespace(__m128i v) {
+        __m128i space = _mm_cmpeq_epi8(v, _mm_set1_epi8(' '));
+        __m128i control = sse2_in_range(v, '\t', '\r');
+        return _mm_xor_si128(_mm_or_si128(space, control), _mm_set1_epi8(-1));
+    }
+
+    static inline __m128i sse2_stop_ident(__m128i v) {
+        __m128i alpha = sse2_in_range(_mm_or_si128(v, _mm_set1_epi8(0x20)), 'a', 'z');
+        __m128i digit = sse2_in_range(v, '0', '9');
+        __m128i underscore = _mm_cmpeq_epi8(v, _mm_set1_epi8('_'));
+        __m128i ident = _mm_or_si128(_mm_or_si128(alpha, digit), underscore);
+        return _mm_xor_si128(ident, _mm_set1_epi8(-1));
+    }
+
+    static inline __m128i sse2_stop_line_end(__m128i v) {
+        return _mm_or_si128(
+            _mm_cmpeq_epi8(v, _mm_set1_epi8('\n')),
+            _mm_cmpeq_epi8(v, _mm_setzero_si128())
+        );
+    }
+
+    static inline __m128i sse2_stop_comment_delimiter(__m128i v) {
+        return _mm_or_si128(
+            _mm_or_si128(
+                _mm_cmpeq_epi8(v, _mm_set1_epi8('*')),
+                _mm_cmpeq_epi8(v, _mm_set1_epi8('/'))
+            ),
+            _mm_cmpeq_epi8(v, _mm_setzero_si128())
+        );
+    }
+
+    static inline __m128i sse2_stop_string_delimiter(__m128i v) {
+        return _mm_or_si128(
+            _mm_or_si128(
+                _mm_cmpeq_epi8(v, _mm_set1_epi8('"')),
+                _mm_cmpeq_epi8(v, _mm_set1_epi8('\''))
+            ),
+            _mm_or_si128(
+                _mm_or_si128(
+                    _mm_cmpeq_epi8(v, _mm_set1_epi8('`')),
+                    _mm_cmpeq_epi8(v, _mm_set1_epi8('\\'))
+                ),
+                _mm_cmpeq_epi8(v, _mm_setzero_si128())
+            )
+        );
+    }
+
+    template<__m128i (*Stop)(__m128i), const char* (*Tail)(const char*, const char*)>
+    static const char* sse2_scan(const char* begin, const char* end) {
+        while (end - begin >= 16) {
+            __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(begin));
+            uint32_t mask = static_cast<uint32_t>(_mm_movemask_epi8(Stop(v)));
+            if (mask != 0)
+                return begin + __builtin_ctz(mask);
+            begin += 16;
+        }
+        return Tail(begin, end);
+    }
+
+    static void sse2_collect_line_starts(const char* begin, const char* end, std::vector<uint32_t>& starts) {
+        const char* it = begin;
+        for (; end - it >= 16; it += 16) {
+            __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(it));
+            uint32_t mask = static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(v, _mm_set1_epi8('\n'))));
+            for (; mask != 0; mask &= mask - 1)
+                starts.push_back(static_cast<uint32_t>(it - begin + __builtin_ctz(mask) + 1));
+        }
+        scalar_collect_line_starts(it, end, starts, begin);
+    }
+
+    // skips the ascii vectors, the others are decoded by the scalar path
+    // which always stops on a sequence boundary
+    static const char* sse2_validate_utf8(const char* begin, const char* end) {
+        while (end - begin >= 16) {
+            __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(begin));
+            if (_mm_movemask_epi8(v) == 0) {
+                begin += 16;
+                continue;
+            }
+
+            const char* vector_end = begin + 16;
+            while (begin < vector_end) {
+                char32_t code_point;
+                std::size_t length = utils::decode_utf8(std::string_view(begin, end - begin), code_point);
+                if (length == 0)
+                    return begin;
+                begin += length;
+            }
+        }
+        return scalar_validate_utf8(begin, end);
+    }
+
+    static const Table s_sse2 = {
+        .skip_whitespace = sse2_scan<sse2_stop_whitespace, scalar_skip<is_whitespace>>,
+        .skip_ident = sse2_scan<sse2_stop_ident, scalar_skip<is_ident>>,
+        .find_line_end = sse2_scan<sse2_stop_line_end, scalar_find<is_line_end>>,
+        .find_comment_delimiter = sse2_scan<sse2_stop_comment_delimiter, scalar_find<is_comment_delimiter>>,
+        .find_string_delimiter = sse2_scan<sse2_stop_string_delimiter, scalar_find<is_string_delimiter>>,
+        .validate_utf8 = sse2_validate_utf8,
+        .collect_line_starts = sse2_collect_line_starts,
+    };
+
+    // AVX2
+
+    #define W_AVX2 __attribute__((target("avx2")))
+
+    W_AVX2 static inline __m256i avx2_in_range(__m256i v, char low, char high) {
+        __m256i shifted = _mm256_sub_epi8(v, _mm256_set1_epi8(low));
+        __m256i limit = _mm256_set1_epi8(static_cast<char>(high - low));
+        return _mm256_cmpeq_epi8(_mm256_min_epu8(shifted, limit), shifted);
+    }
+
+    W_AVX2 static inline __m256i avx2_stop_whitespace(__m256i v) {
+        __m256i space = _mm256_cmpeq_epi8(v, _mm256_set1_epi8(' '));
+        __m256i control = avx2_in_range(v, '\t', '\r');
+        return _mm256_xor_si256(_mm256_or_si256(space, control), _mm256_set1_epi8(-1));
+    }
+
+    W_AVX2 static inline __m256i avx2_stop_ident(__m256i v) {
+        __m256i alpha = avx2_in_range(_mm256_or_si256(v, _mm256_set1_epi8(0x20)), 'a', 'z');
+        __m256i digit = avx2_in_range(v, '0', '9');
+        __m256i underscore = _mm256_cmpeq_epi8(v, _mm256_set1_epi8('_'));
+        __m256i ident = _mm256_or_si256(_mm256_or_si256(alpha, digit), underscore);
+        return _mm256_xor_si256(ident, _mm256_set1_epi8(-1));
+    }
+
+    W_AVX2 static inline __m256i avx2_stop_line_end(__m256i v) {
+        return _mm256_or_si256(
+            _mm256_cmpeq_epi8(v, _mm256_set1_epi8('\n')),
+            _mm256_cmpeq_epi8(v, _mm256_setzero_si256())
+        );
+    }
+
+    W_AVX2 static inline __m256i avx2_stop_comment_delimiter(__m256i v) {
+        return _mm256_or_si256(
+            _mm256_or_si256(
+                _mm256_cmpeq_epi8(v, _mm256_set1_epi8('*')),
+                _mm256_cmpeq_epi8(v, _mm256_set1_epi8('/'))
+            ),
+            _mm256_cmpeq_epi8(v, _mm256_setzero_si256())
+        );
+    }
+
+    W_AVX2 static inline __m256i avx2_stop_string_delimiter(__m256i v) {
+        return _mm256_or_si256(
+            _mm256_or_si256(
+                _mm256_cmpeq_epi8(v, _mm256_set1_epi8('"')),
+                _mm256_cmpeq_epi8(v, _mm256_set1_epi8('\''))
+            ),
+            _mm256_or_si256(
+                _mm256_or_si256(
+                    _mm256_cmpeq_epi8(v, _mm256_set1_epi8('`')),
+                    _mm256_cmpeq_epi8(v, _mm256_set1_epi8('\\'))
+                ),
+                _mm256_cmpeq_epi8(v, _mm256_setzero_si256())
+            )
+        );
+    }
+
+    template<__m256i (*Stop)(__m256i), const char* (*Tail)(const char*, const char*)>
+    W_AVX2 static const char* avx2_scan(const char* begin, const char* end) {
+        while (end - begin >= 32) {
+            __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(begin));
+            uint32_t mask = static_cast<uint32_t>(_mm256_movemask_epi8(Stop(v)));
+            if (mask != 0)
+                return begin + __builtin_ctz(mask);
+            begin += 32;
+        }
+        return Tail(begin, end);
+    }
+
+    W_AVX2 static void avx2_collect_line_starts(const char* begin, const char* end, std::vector<uint32_t>& starts) {
+        const char* it = begin;
+        for (; end - it >= 32; it += 32) {
+            __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(it));
+            uint32_t mask = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(v, _mm256_set1_epi8('\n'))));
+            for (; mask != 0; mask &= mask - 1)
+                starts.push_back(static_cast<uint32_t>(it - begin + __builtin_ctz(mask) + 1));
+        }
+        scalar_collect_line_starts(it, end, starts, begin);
+    }
+
+    // utf-8 validation with lookup tables (Keiser and Lemire, "Validating
+    // UTF-8 In Less Than One Instruction Per Byte"): the first two nibbles
+    // and the high nibble of the next byte of every pair index three tables
+    // whose bitwise and is the set of errors of the pair, the 3 and 4 byte
+    // sequences are checked by the expected continuations
+    //
+    // the vectors only tell if there is an error, its position is found by
+    // the scalar path from the last sequence start before the vector
+
+    static constexpr uint8_t s_too_short = 1 << 0;
+    static constexpr uint8_t s_too_long = 1 << 1;
+    static constexpr uint8_t s_overlong_3 = 1 << 2;
+    static constexpr uint8_t s_too_large = 1 << 3;
+    static constexpr uint8_t s_surrogate = 1 << 4;
+    static constexpr uint8_t s_overlong_2 = 1 << 5;
+    static constexpr uint8_t s_too_large_1000 = 1 << 6;
+    static constexpr uint8_t s_overlong_4 = 1 << 6;
+    static constexpr uint8_t s_two_continuations = 1 << 7;
+    static constexpr uint8_t s_carry = s_too_short | s_too_long | s_two_continuations;
+
+    W_AVX2 static inline __m256i avx2_lookup(__m256i nibbles, const uint8_t (&table)[16]) {
+        __m128i lane = _mm_loadu_si128(reinterpret_cast<const __m128i*>(table));
+        return _mm256_shuffle_epi8(_mm256_broadcastsi128_si256(lane), nibbles);
+    }
+
+    W_AVX2 static inline __m256i avx2_high_nibbles(__m256i v) {
+        return _mm256_and_si256(_mm256_srli_epi16(v, 4), _mm256_set1_epi8(0x0f));
+    }
+
+    W_AVX2 static inline __m256i avx2_utf8_errors(__m256i input, __m256i previous) {
+        static constexpr uint8_t first_high[16] = {
+            s_too_long, s_too_long, s_too_long, s_too_long,
+            s_too_long, s_too_long, s_too_long, s_too_long,
+            s_two_continuations, s_two_continuations, s_two_continuations, s_two_continuations,
+            s_too_short | s_overlong_2,
+            s_too_short,
+            s_too_short | s_overlong_3 | s_surrogate,
+            s_too_short | s_too_large | s_too_large_1000 | s_overlong_4,
+        };
+        static constexpr uint8_t first_low[16] = {
+            s_carry | s_overlong_3 | s_overlong_2 | s_overlong_4,
+            s_carry | s_overlong_2,
+            s_carry,
+            s_carry,
+            s_carry | s_too_large,
+            s_carry | s_too_large | s_too_large_1000,
+            s_carry | s_too_large | s_too_large_1000,
+            s_carry | s_too_large | s_too_large_1000,
+            s_carry | s_too_large | s_too_large_1000,
+            s_carry | s_too_large | s_too_large_1000,
+            s_carry | s_too_large | s_too_large_1000,
+            s_carry | s_too_large | s_too_large_1000,
+            s_carry | s_too_large | s_too_large_1000,
+            s_carry | s_too_large | s_too_large_1000 | s_surrogate,
+            s_carry | s_too_large | s_too_large_1000,
+            s_carry | s_too_large | s_too_large_1000,
+        };
+        static constexpr uint8_t second_high[16] = {
+            s_too_short, s_too_short, s_too_short, s_too_short,
+            s_too_short, s_too_short, s_too_short, s_too_short,
+            s_too_long | s_overlong_2 | s_two_continuations | s_overlong_3 | s_too_large_1000 | s_overlong_4,
+            s_too_long | s_overlong_2 | s_two_continuations | s_overlong_3 | s_too_large,
+            s_too_long | s_overlong_2 | s_two_continuations | s_surrogate | s_too_large,
+            s_too_long | s_overlong_2 | s_two_continuations | s_surrogate | s_too_large,
+            s_too_short, s_too_short, s_too_short, s_too_short,
+        };
+
+        // the bytes 1, 2 and 3 positions before, taken from the previous
+        // vector for the first ones
+        __m256i carried = _mm256_permute2x128_si256(previous, input, 0x21);
+        __m256i previous_1 = _mm256_alignr_epi8(input, carried, 15);
+        __m256i previous_2 = _mm256_alignr_epi8(input, carried, 14);
+        __m256i previous_3 = _mm256_alignr_epi8(input, carried, 13);
+
+        __m256i special_cases = _mm256_and_si256(
+            _mm256_and_si256(
+                avx2_lookup(avx2_high_nibbles(previous_1), first_high),
+                avx2_lookup(_mm256_and_si256(previous_1, _mm256_set1_epi8(0x0f)), first_low)
+            ),
+            avx2_lookup(avx2_high_nibbles(input), second_high)
+        );
+
+        // only 111xxxxx two bytes before or 1111xxxx three bytes before keep
+        // their high bit, the byte must be a continuation
+        __m256i third = _mm256_subs_epu8(previous_2, _mm256_set1_epi8(static_cast<char>(0xe0 - 0x80)));
+        __m256i fourth = _mm256_subs_epu8(previous_3, _mm256_set1_epi8(static_cast<char>(0xf0 - 0x80)));
+        __m256i continuations = _mm256_and_si256(_mm256_or_si256(third, fourth), _mm256_set1_epi8(static_cast<char>(0x80)));
+
+        return _mm256_xor_si256(continuations, special_cases);
+    }
+
+    // start of the sequence which may cross it, a lead byte up to 3 bytes
+    // before it
+    static const char* utf8_sequence_start(const char* begin, const char* it) {
+        for (std::size_t i = 1; i <= 3 && i <= static_cast<std::size_t>(it - begin); i++) {
+            unsigned char c = static_cast<unsigned char>(it[-i]);
+            if (c >= 0xc0)
+                return it - i;
+            if (c < 0x80)
+                break;
+        }
+        return it;
+    }
+
+    W_AVX2 static const char* avx2_validate_utf8(const char* begin, const char* end) {
+        const char* it = begin;
+        __m256i previous = _mm256_setzero_si256();
+
+        for (; end - it >= 32; it += 32) {
+            __m256i input = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(it));
+
+            // an ascii vector is only wrong if the previous one ends in the
+            // middle of a sequence, which the next vector checks anyway
+            __m256i errors = _mm256_movemask_epi8(input) == 0 && _mm256_movemask_epi8(previous) == 0
+                ? _mm256_setzero_si256()
+                : avx2_utf8_errors(input, previous);
+            if (!_mm256_testz_si256(errors, errors))
+                return scalar_validate_utf8(utf8_sequence_start(begin, it), end);
+
+            previous = input;
+        }
+
+        return scalar_validate_utf8(utf8_sequence_start(begin, it), end);
+    }
+
+    static const Table s_avx2 = {
+        .skip_whitespace = avx2_scan<avx2_stop_whitespace, sse2_scan<sse2_stop_whitespace, scalar_skip<is_whitespace>>>,
+        .skip_ident = avx2_scan<avx2_stop_ident, sse2_scan<sse2_stop_ident, scalar_skip<is_ident>>>,
+        .find_line_end = avx2_scan<avx2_stop_line_end, sse2_scan<sse2_stop_line_end, scalar_find<is_line_end>>>,
+        .find_comment_delimiter = avx2_scan<avx2_stop_comment_delimiter, sse2_scan<sse2_stop_comment_delimiter, scalar_find<is_comment_delimiter>>>,
+        .find_string_delimiter = avx2_scan<avx2_stop_string_delimiter, sse2_scan<sse2_stop_string_delimiter, scalar_find<is_string_delimiter>>>,
+        .validate_utf8 = avx2_validate_utf8,
+        .collect_line_starts = avx2_collect_line_starts,
+    };
+
+    #undef W_AVX2
+#endif
+
+    bool is_supported(Isa isa) {
+        switch (isa) {
+            case Isa::Scalar: return true;
+#if defined(W_SCANNERS_X86)
+            case Isa::Sse2: return __builtin_cpu_supports("sse2");
+            case Isa::Avx2: return __builtin_cpu_supports("avx2");
+#endif
+            default: return false;
+        }
+    }
+
+    const Table& table(Isa isa) {
+        switch (isa) {
+#if defined(W_SCANNERS_X86)
+            case Isa::Sse2: return s_sse2;
+            case Isa::Avx2: return s_avx2;
+#endif
+            default: return s_scalar;
+        }
+    }
+
+    const Table& select_best_table() {
+        if (is_supported(Isa::Avx2))
+            return table(Isa::Avx2);
+        if (is_supported(Isa::Sse2))
+            return table(Isa::Sse2);
+        return table(Isa::Scalar);
+    }
+}
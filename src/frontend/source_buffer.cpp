@@ -0,0 +1,147 @@
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <iterator>
+#include <system_error>
+#include <utility>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define W_HAS_MMAP 1
+#else
+#include <fstream>
+#endif
+
+#include <frontend/source_buffer.hpp>
+#include <frontend/stream_reader.hpp>
+
+namespace W {
+    SourceBuffer::SourceBuffer(const char* data, std::size_t size, Storage storage, std::size_t capacity):
+        m_data(data),
+        m_size(size),
+        m_capacity(std::max(size, capacity)),
+        m_storage(storage)
+    {}
+
+    SourceBuffer::SourceBuffer(SourceBuffer&& other) noexcept:
+        m_data(std::exchange(other.m_data, nullptr)),
+        m_size(std::exchange(other.m_size, 0)),
+        m_capacity(std::exchange(other.m_capacity, 0)),
+        m_storage(std::exchange(other.m_storage, Storage::Borrowed))
+    {}
+
+    SourceBuffer::~SourceBuffer() {
+        release();
+    }
+
+    SourceBuffer& SourceBuffer::operator=(SourceBuffer&& other) noexcept {
+        if (this != &other) {
+            release();
+            m_data = std::exchange(other.m_data, nullptr);
+            m_size = std::exchange(other.m_size, 0);
+            m_capacity = std::exchange(other.m_capacity, 0);
+            m_storage = std::exchange(other.m_storage, Storage::Borrowed);
+        }
+        return *this;
+    }
+
+    void SourceBuffer::release() {
+        switch (m_storage) {
+            case Storage::Owned: delete[] m_data; break;
+#if defined(W_HAS_MMAP)
+            case Storage::Mapped: munmap(const_cast<char*>(m_data), m_size); break;
+#endif
+            default: break;
+        }
+        m_data = nullptr;
+        m_size = 0;
+        m_capacity = 0;
+    }
+
+    SourceBuffer SourceBuffer::borrow(std::string_view data) {
+        return SourceBuffer(data.data(), data.size(), Storage::Borrowed);
+    }
+
+    SourceBuffer SourceBuffer::load(std::istream& input) {
+        // bulk reads into an owned buffer grown as needed
+        return StreamReader(input).finish();
+    }
+
+    SourceBuffer SourceBuffer::edit(std::string_view source, const TextEdit& edit) {
+        std::size_t size = source.size() - edit.removed + edit.inserted.size();
+        // an edited file is usually edited again, the next edits growing it
+        // by less than the room left are made in place
+        std::size_t capacity = size + size / 8 + 4096;
+        char* data = new char[capacity];
+
+        std::memcpy(data, source.data(), edit.offset);
+        std::memcpy(data + edit.offset, edit.inserted.data(), edit.inserted.size());
+        std::memcpy(
+            data + edit.offset + edit.inserted.size(),
+            source.data() + edit.offset + edit.removed,
+            source.size() - edit.offset - edit.removed
+        );
+
+        return SourceBuffer(data, size, Storage::Owned, capacity);
+    }
+
+    void SourceBuffer::apply(const TextEdit& edit) {
+        std::size_t size = m_size - edit.removed + edit.inserted.size();
+        if (m_storage != Storage::Owned || size > m_capacity) {
+            *this = SourceBuffer::edit(view(), edit);
+            return;
+        }
+
+        // the memory of an owned buffer was allocated writable
+        char* data = const_cast<char*>(m_data);
+        std::memmove(
+            data + edit.offset + edit.inserted.size(),
+            data + edit.offset + edit.removed,
+            m_size - edit.offset - edit.removed
+        );
+        std::memcpy(data + edit.offset, edit.inserted.data(), edit.inserted.size());
+        m_size = size;
+    }
+
+    SourceBuffer SourceBuffer::map_file(const std::filesystem::path& path) {
+#if defined(W_HAS_MMAP)
+        int fd = open(path.c_str(), O_RDONLY);
+        if (fd < 0)
+            throw std::system_error(errno, std::generic_category(), path.string());
+
+        struct stat infos;
+        if (fstat(fd, &infos) < 0) {
+            int error = errno;
+            close(fd);
+            throw std::system_error(error, std::generic_category(), path.string());
+        }
+
+        std::size_t size = static_cast<std::size_t>(infos.st_size);
+        // mmap refuses empty mappings
+        if (size == 0) {
+            close(fd);
+            return SourceBuffer(nullptr, 0, Storage::Borrowed);
+        }
+
+        void* data = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        int error = errno;
+        close(fd);
+        if (data == MAP_FAILED)
+            throw std::system_error(error, std::generic_category(), path.string());
+
+        // the lexer walks the file from the start to the end once
+        madvise(data, size, MADV_SEQUENTIAL);
+
+        return SourceBuffer(static_cast<const char*>(data), size, Storage::Mapped);
+#else
+        std::ifstream input(path, std::ios::binary);
+        if (!input)
+            throw std::system_error(errno, std::generic_category(), path.string());
+
+        return load(input);
+#endif
+    }
+}
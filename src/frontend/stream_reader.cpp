@@ -0,0 +1,125 @@
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <system_error>
+#include <utility>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <unistd.h>
+#define W_HAS_READ 1
+#endif
+
+#include <frontend/stream_reader.hpp>
+
+namespace W {
+    // the lexer refuses files over 4GiB
+    static constexpr std::size_t s_max_size = std::size_t(1) << 32;
+
+    StreamReader::StreamReader(int fd, std::size_t chunk_size):
+        StreamReader(fd, nullptr, chunk_size)
+    {}
+
+    StreamReader::StreamReader(std::istream& input, std::size_t chunk_size):
+        StreamReader(-1, &input, chunk_size)
+    {}
+
+    StreamReader::StreamReader(int fd, std::istream* input, std::size_t chunk_size):
+        m_fd(fd),
+        m_input(input),
+        m_chunk_size(std::max(chunk_size, s_min_chunk_size)),
+        m_data(nullptr),
+        m_size(0),
+        m_capacity(0),
+        m_exhausted(false)
+    {
+#if !defined(W_HAS_READ)
+        if (m_input == nullptr)
+            throw std::system_error(std::make_error_code(std::errc::not_supported), "cannot stream a file descriptor");
+#endif
+    }
+
+    StreamReader::StreamReader(StreamReader&& other) noexcept:
+        m_fd(std::exchange(other.m_fd, -1)),
+        m_input(std::exchange(other.m_input, nullptr)),
+        m_chunk_size(other.m_chunk_size),
+        m_data(std::exchange(other.m_data, nullptr)),
+        m_size(std::exchange(other.m_size, 0)),
+        m_capacity(std::exchange(other.m_capacity, 0)),
+        m_exhausted(std::exchange(other.m_exhausted, true))
+    {}
+
+    StreamReader::~StreamReader() {
+        delete[] m_data;
+    }
+
+    bool StreamReader::refill(std::size_t count) {
+        if (m_exhausted)
+            return false;
+
+        std::size_t target = std::min(std::max(count, m_chunk_size), s_max_size - m_size);
+        if (target == 0)
+            throw std::length_error("the streamed input is bigger than 4GiB");
+        if (m_size + target > m_capacity)
+            reserve(std::min(std::max(m_capacity * 2, m_size + target), s_max_size));
+
+        // pipes return partial reads, read until the chunk is full
+        std::size_t read = 0;
+        while (read < target) {
+            std::size_t got = read_some(m_data + m_size + read, target - read);
+            if (got == 0) {
+                m_exhausted = true;
+                break;
+            }
+            read += got;
+        }
+        m_size += read;
+
+        return read != 0;
+    }
+
+    void StreamReader::reserve(std::size_t capacity) {
+        // doubled every time, every byte is copied a constant number of times
+        // on average
+        char* data = new char[capacity];
+        if (m_size != 0)
+            std::memcpy(data, m_data, m_size);
+
+        delete[] m_data;
+        m_data = data;
+        m_capacity = capacity;
+    }
+
+    std::size_t StreamReader::read_some(char* data, std::size_t count) {
+        if (m_input != nullptr) {
+            m_input->read(data, static_cast<std::streamsize>(count));
+            return static_cast<std::size_t>(m_input->gcount());
+        }
+
+#if defined(W_HAS_READ)
+        for (;;) {
+            ssize_t got = ::read(m_fd, data, count);
+            if (got >= 0)
+                return static_cast<std::size_t>(got);
+            if (errno != EINTR)
+                throw std::system_error(errno, std::generic_category(), "cannot read the input");
+        }
+#else
+        return 0;
+#endif
+    }
+
+    SourceBuffer StreamReader::finish() {
+        while (refill()) {}
+
+        std::size_t size = std::exchange(m_size, 0);
+        std::size_t capacity = std::exchange(m_capacity, 0);
+        if (size == 0) {
+            delete[] std::exchange(m_data, nullptr);
+            return SourceBuffer::borrow(std::string_view());
+        }
+
+        // the spare capacity is kept rather than copied once more
+        return SourceBuffer(std::exchange(m_data, nullptr), size, SourceBuffer::Storage::Owned, capacity);
+    }
+}
@@ -0,0 +1,66 @@
+#include <algorithm>
+
+#include <frontend/token_buffer.hpp>
+
+namespace W {
+    template<typename T>
+    static void splice_column(std::vector<T>& column, std::size_t begin, std::size_t end, const std::vector<T>& replacement) {
+        // overwrites the common part so only the size difference moves the tail
+        std::size_t common = std::min(end - begin, replacement.size());
+        std::copy_n(replacement.begin(), common, column.begin() + begin);
+
+        if (common < replacement.size())
+            column.insert(column.begin() + end, replacement.begin() + common, replacement.end());
+        else
+            column.erase(column.begin() + begin + common, column.begin() + end);
+    }
+
+    TokenBuffer::TokenBuffer(FileId file):
+        m_file(file),
+        m_source(SourceManager::global().file(file).content())
+    {}
+
+    TokenBuffer::TokenBuffer():
+        m_file(),
+        m_source()
+    {}
+
+    void TokenBuffer::bind(FileId file) {
+        m_file = file;
+        m_source = SourceManager::global().file(file).content();
+    }
+
+    void TokenBuffer::reserve(std::size_t capacity) {
+        m_kinds.reserve(capacity);
+        m_offsets.reserve(capacity);
+        m_lengths.reserve(capacity);
+        m_payloads.reserve(capacity);
+    }
+
+    void TokenBuffer::append(const TokenBuffer& other, std::size_t from) {
+        m_kinds.insert(m_kinds.end(), other.m_kinds.begin() + from, other.m_kinds.end());
+        m_offsets.insert(m_offsets.end(), other.m_offsets.begin() + from, other.m_offsets.end());
+        m_lengths.insert(m_lengths.end(), other.m_lengths.begin() + from, other.m_lengths.end());
+        m_payloads.insert(m_payloads.end(), other.m_payloads.begin() + from, other.m_payloads.end());
+    }
+
+    void TokenBuffer::splice(std::size_t begin, std::size_t end, const TokenBuffer& replacement, int64_t shift) {
+        for (std::size_t i = end; i < m_offsets.size(); i++)
+            m_offsets[i] = static_cast<uint32_t>(m_offsets[i] + shift);
+
+        splice_column(m_kinds, begin, end, replacement.m_kinds);
+        splice_column(m_offsets, begin, end, replacement.m_offsets);
+        splice_column(m_lengths, begin, end, replacement.m_lengths);
+        splice_column(m_payloads, begin, end, replacement.m_payloads);
+
+        m_file = replacement.m_file;
+        m_source = replacement.m_source;
+    }
+
+    void TokenBuffer::erase_front(std::size_t count) {
+        m_kinds.erase(m_kinds.begin(), m_kinds.begin() + count);
+        m_offsets.erase(m_offsets.begin(), m_offsets.begin() + count);
+        m_lengths.erase(m_lengths.begin(), m_lengths.begin() + count);
+        m_payloads.erase(m_payloads.begin(), m_payloads.begin() + count);
+    }
+}
@@ -1,32 +1,128 @@
+#include <algorithm>
+#include <bit>
+#include <cassert>
+#include <utility>
+
 #include <frontend/lexer.hpp>
 #include <frontend/token_stream.hpp>
 
 namespace W {
-    TokenStream::TokenStream(Lexer& lexer):
-        m_lexer(lexer),
+    static constexpr std::size_t s_no_eof = SIZE_MAX;
+
+    TokenStream::Checkpoint::Checkpoint(TokenStream& stream, std::size_t position):
+        m_stream(&stream),
+        m_position(position),
+        m_depth(stream.m_checkpoints.size())
+    {
+        stream.m_checkpoints.push_back(position);
+    }
+
+    TokenStream::Checkpoint::Checkpoint(Checkpoint&& other) noexcept:
+        m_stream(std::exchange(other.m_stream, nullptr)),
+        m_position(other.m_position),
+        m_depth(other.m_depth)
+    {}
+
+    TokenStream::Checkpoint::~Checkpoint() {
+        if (m_stream == nullptr)
+            return;
+
+        assert(m_stream->m_checkpoints.size() == m_depth + 1 && "checkpoints must be released in the reverse order");
+        m_stream->m_checkpoints.pop_back();
+    }
+
+    void TokenStream::Checkpoint::rewind() {
+        m_stream->m_index = m_position;
+    }
+
+    TokenStream::TokenStream(Lexer& lexer, std::size_t capacity):
+        m_lexer(&lexer),
+        m_pipelined(nullptr),
+        m_external(nullptr),
+        m_external_end(0),
+        m_external_eof(),
+        m_file(lexer.file()),
+        m_source(SourceManager::global().file(lexer.file()).content()),
+        m_ring(std::bit_ceil(std::max<std::size_t>(capacity, 2))),
+        m_pulled(0),
+        m_eof(s_no_eof),
         m_index(0)
     {}
 
-    const Token& TokenStream::next() {
-        if (m_index == m_tokens.size()) {
-            m_tokens.push_back(m_lexer.next());
-        }
-        return m_tokens[m_index++];
+    TokenStream::TokenStream(PipelinedLexer& lexer, std::size_t capacity):
+        m_lexer(nullptr),
+        m_pipelined(&lexer),
+        m_external(nullptr),
+        m_external_end(0),
+        m_external_eof(),
+        m_file(lexer.file()),
+        m_source(SourceManager::global().file(lexer.file()).content()),
+        m_ring(std::bit_ceil(std::max<std::size_t>(capacity, 2))),
+        m_pulled(0),
+        m_eof(s_no_eof),
+        m_index(0)
+    {}
+
+    TokenStream::TokenStream(const TokenBuffer& tokens):
+        TokenStream(tokens, 0, tokens.size() - 1)
+    {}
+
+    TokenStream::TokenStream(const TokenBuffer& tokens, std::size_t begin, std::size_t end):
+        m_lexer(nullptr),
+        m_pipelined(nullptr),
+        m_external(&tokens),
+        m_external_end(end),
+        m_external_eof { tokens.offsets()[end], 0, 0, TokenKind::Eof },
+        m_file(tokens.file()),
+        m_source(tokens.source()),
+        m_pulled(0),
+        m_eof(s_no_eof),
+        m_index(begin)
+    {
+        assert(begin <= end && end < tokens.size() && "the range must end before the Eof of the buffer");
+    }
+
+    TokenStream::Checkpoint TokenStream::checkpoint() {
+        return Checkpoint(*this, m_index);
     }
 
-    const Token& TokenStream::peek(size_t advance) {
-        while (m_tokens.size() <= m_index + advance) {
-            m_tokens.push_back((m_lexer.next()));
+    std::size_t TokenStream::matching(TokenKind open, TokenKind close) const {
+        assert(m_external != nullptr && "only the kinds of a token buffer can be scanned");
+
+        std::span<const TokenKind> kinds = m_external->kinds();
+        std::size_t depth = 1;
+        for (std::size_t i = m_index; i < m_external_end; i++) {
+            if (kinds[i] == open)
+                depth++;
+            else if (kinds[i] == close && --depth == 0)
+                return i;
         }
-        return m_tokens[m_index + advance];
+
+        return m_external_end;
     }
 
-    void TokenStream::commit() {
-        m_tokens.erase(m_tokens.begin(), m_tokens.begin() + m_index);
-        m_index = 0;
+    Token TokenStream::pull(std::size_t position) {
+        // the lexer returns Eof forever, only the first one is kept
+        while (m_pulled <= position && m_eof == s_no_eof) {
+            // the slot to fill still holds a token which may be read
+            if (m_pulled - oldest_needed() >= m_ring.size())
+                grow();
+
+            Token token = m_pipelined != nullptr ? m_pipelined->next() : m_lexer->next();
+            m_ring[m_pulled & (m_ring.size() - 1)] = token;
+            if (token.kind == TokenKind::Eof)
+                m_eof = m_pulled;
+            m_pulled++;
+        }
+
+        return m_ring[std::min(position, m_eof) & (m_ring.size() - 1)];
     }
 
-    void TokenStream::uncommit() {
-        m_index = 0;
+    void TokenStream::grow() {
+        std::vector<Token> ring(m_ring.size() * 2);
+        for (std::size_t i = oldest_needed(); i < m_pulled; i++)
+            ring[i & (ring.size() - 1)] = m_ring[i & (m_ring.size() - 1)];
+
+        m_ring = std::move(ring);
     }
 }
@@ -0,0 +1,43 @@
+#include <bit>
+
+#include <literals.hpp>
+
+namespace W {
+    LiteralTable& LiteralTable::global() {
+        static LiteralTable table;
+        return table;
+    }
+
+    LiteralId LiteralTable::intern_integer(uint64_t value) {
+        if (value < s_table_bit)
+            return static_cast<LiteralId>(value);
+
+        return intern(value);
+    }
+
+    LiteralId LiteralTable::intern_float(double value) {
+        return intern(std::bit_cast<uint64_t>(value));
+    }
+
+    LiteralId LiteralTable::intern(uint64_t bits) {
+        std::lock_guard lock(m_mutex);
+
+        auto [it, inserted] = m_indices.try_emplace(bits, static_cast<uint32_t>(m_values.size()));
+        if (inserted)
+            m_values.push_back(bits);
+
+        return static_cast<LiteralId>(it->second | s_table_bit);
+    }
+
+    LiteralId LiteralTable::intern_string(std::string_view value) {
+        std::lock_guard lock(m_mutex);
+
+        if (auto it = m_string_indices.find(value); it != m_string_indices.end())
+            return static_cast<LiteralId>(it->second);
+
+        uint32_t index = static_cast<uint32_t>(m_strings.push_back(std::string(value)));
+        m_string_indices.emplace(m_strings[index], index);
+
+        return static_cast<LiteralId>(index);
+    }
+}
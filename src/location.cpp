@@ -1,5 +1,8 @@
 #include <location.hpp>
 
 auto fmt::formatter<W::Location>::format(W::Location location, format_context& ctx) const -> format_context::iterator {
-    return formatter<std::string>::format(fmt::format("{}:{}:{}", location.file_path->c_str(), location.start_line, location.start_col), ctx);
+    const W::SourceFile& file = W::SourceManager::global().file(location.file);
+    W::LineColumn position = file.line_column(location.begin);
+
+    return formatter<std::string>::format(fmt::format("{}:{}:{}", file.path().c_str(), position.line, position.column), ctx);
 }
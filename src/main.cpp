@@ -1,27 +1,63 @@
-#include <iostream>
-
-#include <frozen/string.h>
-#include <frozen/unordered_map.h>
+#include <charconv>
+#include <string_view>
+#include <system_error>
 
+#include <diagnostics.hpp>
+#include <driver.hpp>
 #include <errors.hpp>
-#include <frontend/lexer.hpp>
-#include <frontend/parser.hpp>
-#include <frontend/token_stream.hpp>
+
+static int usage(const char* program) {
+    fmt::print(stderr, "usage: {} [-j jobs] [--cache directory] <file|directory|->...\n", program);
+    return 1;
+}
 
 int main(int argc, char **argv) {
-    std::istringstream data(
-        "mut a := 0"
-    );
-    W::Lexer lexer("test.w", data);
-    W::TokenStream token_stream(lexer);
-    W::Parser parser(token_stream);
+    W::Driver::Options options;
+    int first = 1;
+
+    while (first < argc) {
+        std::string_view option = argv[first];
+
+        if (option.starts_with("-j")) {
+            // -j N or -jN, 0 uses every hardware thread
+            std::string_view jobs = option.substr(2);
+            if (jobs.empty() && first + 1 < argc)
+                jobs = argv[++first];
 
+            auto [end, error] = std::from_chars(jobs.data(), jobs.data() + jobs.size(), options.jobs);
+            if (jobs.empty() || error != std::errc() || end != jobs.data() + jobs.size())
+                return usage(argv[0]);
+        } else if (option == "--cache") {
+            if (first + 1 >= argc)
+                return usage(argv[0]);
+            options.cache = argv[++first];
+        } else {
+            break;
+        }
+        first++;
+    }
+
+    if (first >= argc)
+        return usage(argv[0]);
+
+    W::Driver driver(options);
     try {
-        auto stmt = parser.next();
-        assert(stmt->get_type() == W::Ast::NodeType::DeclareVariableStatement);
+        for (int i = first; i < argc; i++)
+            driver.add(argv[i]);
+
+        driver.run();
     } catch (W::Exception& e) {
         fmt::print("{} error: {}\n", e.get_location(), e.what());
+        return 1;
+    } catch (std::system_error& e) {
+        fmt::print(stderr, "{}\n", e.what());
+        return 1;
     }
 
-    return 0;
+    for (const W::Driver::Failure& failure : driver.failures())
+        fmt::print(stderr, "{}: {}\n", failure.path.string(), failure.message);
+    for (const W::Diagnostic& diagnostic : driver.diagnostics().all())
+        fmt::print("{} error: {}\n", diagnostic.location, diagnostic.message);
+
+    return driver.failures().empty() && driver.diagnostics().empty() ? 0 : 1;
 }
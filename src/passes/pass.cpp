@@ -1,21 +1,68 @@
 #include <passes/pass.hpp>
 
 namespace W::Passes {
-    void VisitorPass::handle_statement(std::vector<Ast::StatementPtr>& stmt_list) {}
-    void VisitorPass::handle_statement(Ast::StatementPtr& stmt) {}
-    void VisitorPass::handle_expression(std::vector<Ast::ExpressionPtr>& expr_list) {}
-    void VisitorPass::handle_expression(Ast::ExpressionPtr& expr) {}
+    void VisitorPass::handle_statement(std::span<Ast::StatementPtr> stmt_list) {
+        for (Ast::StatementPtr& stmt : stmt_list)
+            handle_statement(stmt);
+    }
 
-    void VisitorPass::handle_children(Ast::ExpressionType<>& expr) {}
+    void VisitorPass::handle_statement(Ast::StatementPtr& stmt) {
+        if (stmt != nullptr)
+            stmt->visit(*this);
+    }
+
+    void VisitorPass::handle_expression(std::span<Ast::ExpressionPtr> expr_list) {
+        for (Ast::ExpressionPtr& expr : expr_list)
+            handle_expression(expr);
+    }
+
+    void VisitorPass::handle_expression(Ast::ExpressionPtr& expr) {
+        if (expr != nullptr)
+            expr->visit(*this);
+    }
+
+    void VisitorPass::handle_children(Ast::ExpressionType<>& expr) {
+        if (expr.is_expression())
+            handle_expression(expr.get_expression());
+    }
+
+    void VisitorPass::handle_children(Ast::ExpressionType<true>& expr) {
+        if (expr.is_expression())
+            handle_expression(expr.get_expression());
+    }
+
+    void VisitorPass::handle_children(Ast::AccessIdentifierExpression& expr) {
+        handle_expression(expr.members);
+    }
+
+    void VisitorPass::handle_children(Ast::CallExpression& expr) {
+        handle_expression(expr.callee);
+        handle_expression(expr.params);
+    }
+
+    void VisitorPass::handle_children(Ast::BinaryExpression& expr) {
+        handle_expression(expr.left);
+        handle_expression(expr.right);
+    }
+
+    void VisitorPass::handle_children(Ast::UnaryExpression& expr) {
+        handle_expression(expr.expr);
+    }
 
-    void VisitorPass::handle_children(Ast::AccessIdentifierExpression& expr) {}
-    void VisitorPass::handle_children(Ast::CallExpression& expr) {}
-    void VisitorPass::handle_children(Ast::BinaryExpression& expr) {}
-    void VisitorPass::handle_children(Ast::UnaryExpression& expr) {}
     void VisitorPass::handle_children(Ast::IdentExpression& expr) {}
-    void VisitorPass::handle_children(Ast::ParentExpression& expr) {}
-    void VisitorPass::handle_children(Ast::ArrayTypeExpression& expr) {}
-    void VisitorPass::handle_children(Ast::SliceTypeExpression& expr) {}
+
+    void VisitorPass::handle_children(Ast::ParentExpression& expr) {
+        handle_expression(expr.expr);
+    }
+
+    void VisitorPass::handle_children(Ast::ArrayTypeExpression& expr) {
+        handle_expression(expr.lenght);
+        handle_expression(expr.inner_type);
+    }
+
+    void VisitorPass::handle_children(Ast::SliceTypeExpression& expr) {
+        handle_expression(expr.inner_type);
+    }
 
     void VisitorPass::handle_children(Ast::BoolLiteral& lit) {}
     void VisitorPass::handle_children(Ast::IntLiteral& lit) {}
@@ -24,7 +71,18 @@ namespace W::Passes {
     void VisitorPass::handle_children(Ast::RuneLiteral& lit) {}
     void VisitorPass::handle_children(Ast::StringLiteral& lit) {}
 
-    void VisitorPass::handle_children(Ast::ExpressionStatement& stmt) {}
-    void VisitorPass::handle_children(Ast::DeclareFunctionStatement& stmt) {}
-    void VisitorPass::handle_children(Ast::DeclareVariableStatement& stmt) {}
+    void VisitorPass::handle_children(Ast::ExpressionStatement& stmt) {
+        handle_expression(stmt.expr);
+    }
+
+    void VisitorPass::handle_children(Ast::DeclareFunctionStatement& stmt) {
+        for (Ast::DeclareFunctionStatement::Parameter& parameter : stmt.parameters)
+            handle_children(parameter.type);
+        handle_children(stmt.return_type);
+        handle_statement(stmt.body);
+    }
+
+    void VisitorPass::handle_children(Ast::DeclareVariableStatement& stmt) {
+        handle_expression(stmt.value);
+    }
 }
@@ -0,0 +1,113 @@
+#include <algorithm>
+
+#include <source_manager.hpp>
+#include <frontend/scanners.hpp>
+
+namespace W {
+    SourceFile::SourceFile(std::filesystem::path path, SourceBuffer buffer):
+        m_path(std::move(path)),
+        m_buffer(std::make_shared<SourceBuffer>(std::move(buffer)))
+    {
+        const char* begin = m_buffer->data();
+        const char* end = begin + m_buffer->size();
+
+        if (const char* invalid = Scanners::validate_utf8(begin, end); invalid != end)
+            m_invalid_utf8 = static_cast<uint32_t>(invalid - begin);
+    }
+
+    const std::vector<uint32_t>& SourceFile::line_starts() const {
+        std::lock_guard lock(m_line_starts_mutex);
+        if (m_line_starts.empty()) {
+            const char* begin = m_buffer->data();
+
+            m_line_starts.push_back(0);
+            Scanners::collect_line_starts(begin, begin + m_buffer->size(), m_line_starts);
+        }
+
+        return m_line_starts;
+    }
+
+    void SourceFile::edit(const TextEdit& edit) {
+        // a snapshot still reads the current version, the file moves on to an
+        // edited copy and the snapshot releases the old one
+        if (m_buffer.use_count() == 1)
+            m_buffer->apply(edit);
+        else
+            m_buffer = std::make_shared<SourceBuffer>(SourceBuffer::edit(m_buffer->view(), edit));
+
+        revalidate_utf8(edit);
+        m_line_starts.clear();
+    }
+
+    void SourceFile::revalidate_utf8(const TextEdit& edit) {
+        auto is_continuation = [](char c) { return (static_cast<unsigned char>(c) & 0xc0) == 0x80; };
+
+        std::optional<uint32_t> previous = m_invalid_utf8;
+        // a sequence is at most 4 bytes long, one ending before the edit is
+        // still the first invalid one
+        if (previous && *previous + 4 <= edit.offset)
+            return;
+
+        const char* data = m_buffer->data();
+        std::size_t size = m_buffer->size();
+
+        // the bytes before the edit are valid (up to previous), so it starts
+        // in a sequence whose first byte is at most 3 bytes before
+        std::size_t begin = edit.offset;
+        while (begin > 0 && edit.offset - begin < 3 && is_continuation(data[begin - 1]))
+            begin--;
+        if (begin > 0 && static_cast<unsigned char>(data[begin - 1]) >= 0xc0)
+            begin--;
+        if (previous)
+            begin = std::min<std::size_t>(begin, *previous);
+
+        // past the inserted text, the first byte which is not a continuation
+        // starts a sequence in both versions
+        std::size_t stop = edit.offset + edit.inserted.size();
+        while (stop < size && is_continuation(data[stop]))
+            stop++;
+
+        m_invalid_utf8.reset();
+        if (const char* invalid = Scanners::validate_utf8(data + begin, data + stop); invalid != data + stop) {
+            m_invalid_utf8 = static_cast<uint32_t>(invalid - data);
+            return;
+        }
+        if (!previous)
+            return;
+
+        // the bytes from stop are the ones of the previous version, shifted
+        std::size_t previous_stop = stop - edit.inserted.size() + edit.removed;
+        if (*previous >= previous_stop) {
+            m_invalid_utf8 = static_cast<uint32_t>(*previous - edit.removed + edit.inserted.size());
+            return;
+        }
+        if (const char* invalid = Scanners::validate_utf8(data + stop, data + size); invalid != data + size)
+            m_invalid_utf8 = static_cast<uint32_t>(invalid - data);
+    }
+
+    LineColumn SourceFile::line_column(uint32_t offset) const {
+        const std::vector<uint32_t>& starts = line_starts();
+        auto line = std::upper_bound(starts.begin(), starts.end(), offset) - 1;
+
+        return LineColumn {
+            static_cast<uint32_t>(line - starts.begin() + 1),
+            offset - *line + 1,
+        };
+    }
+
+    SourceManager& SourceManager::global() {
+        static SourceManager manager;
+        return manager;
+    }
+
+    FileId SourceManager::add(std::filesystem::path path, SourceBuffer buffer) {
+        auto file = std::make_unique<SourceFile>(std::move(path), std::move(buffer));
+
+        std::lock_guard lock(m_mutex);
+        return static_cast<FileId>(m_files.push_back(std::move(file)));
+    }
+
+    void SourceManager::edit(FileId file, const TextEdit& edit) {
+        m_files[static_cast<uint32_t>(file)]->edit(edit);
+    }
+}
@@ -0,0 +1,87 @@
+#include <cstring>
+#include <functional>
+
+#include <symbols.hpp>
+
+namespace W {
+    SymbolTable& SymbolTable::global() {
+        static SymbolTable table;
+        return table;
+    }
+
+    SymbolId SymbolTable::intern(std::string_view name) {
+        std::size_t hash = std::hash<std::string_view>{}(name);
+        uint32_t shard_index = hash & ((1 << s_shard_bits) - 1);
+        uint32_t short_hash = static_cast<uint32_t>(hash >> s_shard_bits);
+
+        Shard& shard = m_shards[shard_index];
+        std::lock_guard lock(shard.mutex);
+
+        if (shard.slots.empty())
+            shard.grow();
+
+        std::size_t mask = shard.slots.size() - 1;
+        for (std::size_t i = short_hash & mask;; i = (i + 1) & mask) {
+            Slot& slot = shard.slots[i];
+
+            if (slot.index == 0) {
+                uint32_t index = shard.names.push_back(shard.store(name));
+                slot = Slot { short_hash, index + 1 };
+
+                // keep the load factor under 1/2
+                if (shard.names.size() * 2 > shard.slots.size())
+                    shard.grow();
+
+                return static_cast<SymbolId>(index << s_shard_bits | shard_index);
+            }
+
+            if (slot.hash == short_hash && shard.names[slot.index - 1] == name)
+                return static_cast<SymbolId>((slot.index - 1) << s_shard_bits | shard_index);
+        }
+    }
+
+    std::string_view SymbolTable::Shard::store(std::string_view name) {
+        if (name.empty())
+            return std::string_view();
+
+        // big names get their own chunk to not waste the current one
+        if (name.size() > s_arena_chunk_size / 4) {
+            chunks.push_back(std::make_unique<char[]>(name.size()));
+            std::memcpy(chunks.back().get(), name.data(), name.size());
+            return std::string_view(chunks.back().get(), name.size());
+        }
+
+        if (chunk_remaining < name.size()) {
+            chunks.push_back(std::make_unique<char[]>(s_arena_chunk_size));
+            chunk_cursor = chunks.back().get();
+            chunk_remaining = s_arena_chunk_size;
+        }
+
+        std::memcpy(chunk_cursor, name.data(), name.size());
+        std::string_view stored(chunk_cursor, name.size());
+        chunk_cursor += name.size();
+        chunk_remaining -= name.size();
+
+        return stored;
+    }
+
+    void SymbolTable::Shard::grow() {
+        std::vector<Slot> old = std::move(slots);
+        slots.assign(old.empty() ? 256 : old.size() * 2, Slot { 0, 0 });
+
+        std::size_t mask = slots.size() - 1;
+        for (const Slot& slot : old) {
+            if (slot.index == 0)
+                continue;
+
+            std::size_t i = slot.hash & mask;
+            while (slots[i].index != 0)
+                i = (i + 1) & mask;
+            slots[i] = slot;
+        }
+    }
+}
+
+auto fmt::formatter<W::SymbolId>::format(W::SymbolId symbol, format_context& ctx) const -> format_context::iterator {
+    return formatter<std::string_view>::format(W::SymbolTable::global().name(symbol), ctx);
+}
@@ -0,0 +1,91 @@
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+#include <utility>
+
+#include <utils/arena.hpp>
+
+namespace W::utils {
+    Arena::Arena(Arena&& other) noexcept {
+        *this = std::move(other);
+    }
+
+    Arena::~Arena() {
+        release();
+    }
+
+    Arena& Arena::operator=(Arena&& other) noexcept {
+        if (this != &other) {
+            release();
+            m_chunk = std::exchange(other.m_chunk, nullptr);
+            m_cursor = std::exchange(other.m_cursor, 0);
+            m_end = std::exchange(other.m_end, 0);
+            m_capacity = std::exchange(other.m_capacity, 0);
+        }
+        return *this;
+    }
+
+    void* Arena::allocate_slow(std::size_t size, std::size_t align) {
+        assert(align <= alignof(std::max_align_t) && "over-aligned types are not supported");
+
+        std::size_t header = (sizeof(Chunk) + align - 1) & ~(align - 1);
+        std::size_t chunk_size = std::clamp(m_capacity, s_min_chunk_size, s_max_chunk_size);
+        // big allocations get their own chunk to not waste the current one
+        bool dedicated = size > chunk_size / 4;
+        if (dedicated)
+            chunk_size = header + size;
+
+        Chunk* chunk = static_cast<Chunk*>(std::malloc(chunk_size));
+        if (chunk == nullptr)
+            throw std::bad_alloc();
+        m_capacity += chunk_size;
+
+        uintptr_t begin = reinterpret_cast<uintptr_t>(chunk) + header;
+        if (dedicated && m_chunk != nullptr) {
+            // kept behind the current chunk which still has free space
+            chunk->previous = m_chunk->previous;
+            chunk->size = chunk_size;
+            m_chunk->previous = chunk;
+            return reinterpret_cast<void*>(begin);
+        }
+
+        chunk->previous = m_chunk;
+        chunk->size = chunk_size;
+        m_chunk = chunk;
+        m_cursor = begin + size;
+        m_end = reinterpret_cast<uintptr_t>(chunk) + chunk_size;
+
+        return reinterpret_cast<void*>(begin);
+    }
+
+    void Arena::adopt(Arena&& other) {
+        if (other.m_chunk == nullptr || this == &other)
+            return;
+        if (m_chunk == nullptr) {
+            *this = std::move(other);
+            return;
+        }
+
+        // kept behind the current chunk, like a dedicated chunk
+        Chunk* last = other.m_chunk;
+        while (last->previous != nullptr)
+            last = last->previous;
+        last->previous = m_chunk->previous;
+        m_chunk->previous = std::exchange(other.m_chunk, nullptr);
+        m_capacity += std::exchange(other.m_capacity, 0);
+
+        other.m_cursor = 0;
+        other.m_end = 0;
+    }
+
+    void Arena::release() {
+        while (m_chunk != nullptr)
+            std::free(std::exchange(m_chunk, m_chunk->previous));
+
+        m_cursor = 0;
+        m_end = 0;
+        m_capacity = 0;
+    }
+}
@@ -0,0 +1,177 @@
+#include <algorithm>
+#include <utility>
+
+#include <utils/thread_pool.hpp>
+
+namespace W::utils {
+    // worker of the current thread, to keep the tasks it submits local
+    static thread_local ThreadPool* s_current_pool = nullptr;
+    static thread_local std::size_t s_current_worker = 0;
+
+    ThreadPool::ThreadPool(unsigned threads):
+        m_queued(0),
+        m_pending(0),
+        m_stop(false)
+    {
+        std::size_t count = threads != 0 ? threads : std::max(std::thread::hardware_concurrency(), 1u);
+
+        m_workers.reserve(count);
+        for (std::size_t i = 0; i < count; i++)
+            m_workers.push_back(std::make_unique<Worker>());
+
+        m_threads.reserve(count);
+        for (std::size_t i = 0; i < count; i++)
+            m_threads.emplace_back(&ThreadPool::run, this, i);
+    }
+
+    ThreadPool::~ThreadPool() {
+        {
+            std::lock_guard lock(m_mutex);
+            m_stop = true;
+        }
+        m_wake.notify_all();
+
+        for (std::thread& thread : m_threads)
+            thread.join();
+    }
+
+    void ThreadPool::submit(Task task) {
+        // an outside task is queued for every worker, a worker draining its
+        // own deque backwards would start the first submitted tasks last
+        Worker& queue = s_current_pool == this ? *m_workers[s_current_worker] : m_injected;
+
+        // counted before being visible, a worker never sees a task which is
+        // not pending yet
+        {
+            std::lock_guard lock(m_mutex);
+            m_pending++;
+            m_queued.fetch_add(1);
+        }
+        {
+            std::lock_guard lock(queue.mutex);
+            queue.tasks.push_back(std::move(task));
+        }
+        m_wake.notify_one();
+    }
+
+    void ThreadPool::wait() {
+        std::unique_lock lock(m_mutex);
+        m_idle.wait(lock, [this] { return m_pending == 0; });
+
+        if (m_error)
+            std::rethrow_exception(std::exchange(m_error, nullptr));
+    }
+
+    void ThreadPool::run_all(std::size_t count, const std::function<void(std::size_t)>& task) {
+        std::mutex mutex;
+        std::condition_variable done;
+        std::size_t left = count;
+        std::exception_ptr error;
+
+        for (std::size_t i = 0; i < count; i++) {
+            submit([&, i] {
+                std::exception_ptr task_error;
+                try {
+                    task(i);
+                } catch (...) {
+                    task_error = std::current_exception();
+                }
+
+                // notified under the lock, the caller cannot return and
+                // destroy it before
+                std::lock_guard lock(mutex);
+                if (task_error && !error)
+                    error = task_error;
+                if (--left == 0)
+                    done.notify_all();
+            });
+        }
+
+        if (s_current_pool == this) {
+            // blocking would take a thread from the pool, possibly the one
+            // which has to run the tasks
+            for (;;) {
+                {
+                    std::lock_guard lock(mutex);
+                    if (left == 0)
+                        break;
+                }
+
+                Task next;
+                if (pop(s_current_worker, next))
+                    execute(next);
+                else
+                    std::this_thread::yield();
+            }
+        } else {
+            std::unique_lock lock(mutex);
+            done.wait(lock, [&] { return left == 0; });
+        }
+
+        if (error)
+            std::rethrow_exception(error);
+    }
+
+    void ThreadPool::run(std::size_t index) {
+        s_current_pool = this;
+        s_current_worker = index;
+
+        for (;;) {
+            Task task;
+            if (pop(index, task)) {
+                execute(task);
+                continue;
+            }
+
+            std::unique_lock lock(m_mutex);
+            m_wake.wait(lock, [this] { return m_stop || m_queued.load() > 0; });
+            if (m_stop && m_queued.load() == 0)
+                return;
+        }
+    }
+
+    bool ThreadPool::pop(std::size_t index, Task& task) {
+        {
+            Worker& worker = *m_workers[index];
+            std::lock_guard lock(worker.mutex);
+            if (!worker.tasks.empty()) {
+                task = std::move(worker.tasks.back());
+                worker.tasks.pop_back();
+                m_queued.fetch_sub(1);
+                return true;
+            }
+        }
+
+        for (std::size_t i = 0; i < m_workers.size(); i++) {
+            Worker& victim = i == 0 ? m_injected : *m_workers[(index + i) % m_workers.size()];
+            std::lock_guard lock(victim.mutex);
+            if (!victim.tasks.empty()) {
+                task = std::move(victim.tasks.front());
+                victim.tasks.pop_front();
+                m_queued.fetch_sub(1);
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    void ThreadPool::execute(Task& task) {
+        std::exception_ptr error;
+        try {
+            task();
+        } catch (...) {
+            error = std::current_exception();
+        }
+        finish(error);
+    }
+
+    void ThreadPool::finish(std::exception_ptr error) {
+        std::lock_guard lock(m_mutex);
+        if (error && !m_error)
+            m_error = error;
+
+        if (--m_pending == 0)
+            m_idle.notify_all();
+    }
+}
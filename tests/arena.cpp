@@ -0,0 +1,73 @@
+#include <cstdint>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <frontend/ast/nodes.hpp>
+#include <frontend/lexer.hpp>
+#include <frontend/parser.hpp>
+#include <frontend/token_stream.hpp>
+#include <utils/arena.hpp>
+
+TEST_CASE("arena") {
+    SECTION("allocation") {
+        W::utils::Arena arena;
+
+        // every object keeps its value and alignment across chunks
+        std::vector<std::pair<char*, double*>> objects;
+        for (int i = 0; i < 10000; i++)
+            objects.emplace_back(arena.make<char>(static_cast<char>(i)), arena.make<double>(i));
+
+        for (int i = 0; i < 10000; i++) {
+            CHECK(*objects[i].first == static_cast<char>(i));
+            CHECK(*objects[i].second == i);
+            CHECK(reinterpret_cast<uintptr_t>(objects[i].second) % alignof(double) == 0);
+        }
+
+        std::vector<int> values = { 1, 2, 3 };
+        std::span<int> span = arena.make_span(std::span<int>(values));
+        CHECK(span.data() != values.data());
+        CHECK(std::vector<int>(span.begin(), span.end()) == values);
+        CHECK(arena.make_span(std::span<int>()).empty());
+
+        std::string big(1 << 20, 'x');
+        CHECK(arena.make_string(big) == big);
+        CHECK(arena.make_string("small") == "small");
+
+        W::utils::Arena moved = std::move(arena);
+        CHECK(arena.capacity() == 0);
+        CHECK(moved.capacity() > big.size());
+        CHECK(*objects[0].second == 0);
+    }
+    SECTION("ast") {
+        std::istringstream data("fn f(a int, mut b int) int { c := g(a, b).x.y }\nf(1, 2)");
+        W::Lexer lexer("test.w", data);
+        W::TokenStream token_stream(lexer);
+        W::utils::Arena arena;
+        W::Diagnostics diagnostics;
+        W::Parser parser(token_stream, arena, diagnostics);
+
+        auto function = static_cast<W::Ast::DeclareFunctionStatement*>(parser.next());
+        REQUIRE(function->get_type() == W::Ast::NodeType::DeclareFunctionStatement);
+        CHECK(function->parameters.size() == 2);
+        REQUIRE(function->body.size() == 1);
+
+        auto declaration = static_cast<W::Ast::DeclareVariableStatement*>(function->body[0]);
+        auto access = static_cast<W::Ast::AccessIdentifierExpression*>(declaration->value);
+        REQUIRE(access->get_type() == W::Ast::NodeType::AccessIdentifierExpression);
+        CHECK(access->members.size() == 3);
+        CHECK(fmt::format("{}", access->location) == "test.w:1:35");
+
+        auto call = static_cast<W::Ast::CallExpression*>(access->members[0]);
+        REQUIRE(call->get_type() == W::Ast::NodeType::CallExpression);
+        CHECK(call->params.size() == 2);
+
+        auto statement = static_cast<W::Ast::ExpressionStatement*>(parser.next());
+        REQUIRE(statement->expr->get_type() == W::Ast::NodeType::CallExpression);
+        CHECK(static_cast<W::Ast::CallExpression*>(statement->expr)->params.size() == 2);
+        CHECK(token_stream.peek().kind == W::TokenKind::Eof);
+    }
+}
@@ -0,0 +1,134 @@
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <symbols.hpp>
+#include <frontend/ast/ast_cache.hpp>
+#include <frontend/lexer.hpp>
+#include <frontend/parser.hpp>
+#include <frontend/token_stream.hpp>
+#include <utils/arena.hpp>
+
+static W::Ast::FlatTree parse(W::FileId file) {
+    W::Lexer lexer(file);
+    W::TokenStream token_stream(lexer);
+    W::utils::Arena arena;
+    W::Diagnostics diagnostics;
+    W::Parser parser(token_stream, arena, diagnostics);
+
+    std::vector<W::Ast::StatementPtr> statements;
+    while (token_stream.peek().kind != W::TokenKind::Eof)
+        statements.push_back(parser.next());
+
+    return W::Ast::FlatTree::build(file, statements);
+}
+
+template<typename T>
+static void check_nodes(const W::Ast::FlatTree& expected, const W::Ast::FlatTree& tree) {
+    REQUIRE(tree.nodes<T>().size() == expected.nodes<T>().size());
+    for (std::size_t i = 0; i < tree.nodes<T>().size(); i++) {
+        auto handle = W::Ast::NodeHandle::make(W::Ast::FlatTree::type_of<T>(), static_cast<uint32_t>(i));
+        CHECK(tree.raw(handle) == expected.raw(handle));
+    }
+}
+
+TEST_CASE("ast_cache") {
+    std::filesystem::path directory = std::filesystem::temp_directory_path() / "w_ast_cache_test";
+    std::filesystem::remove_all(directory);
+
+    static std::string source =
+        "pub fn cached_function(a int, mut b []int) int { c := g(a, -b).x }\n"
+        "(1 + 2) * 3.5\n"
+        "const s := \"a\\tb\"\n"
+        "type t := [4]cached_type\n";
+    W::FileId file = W::SourceManager::global().add("test.w", W::SourceBuffer::borrow(source));
+    W::Ast::FlatTree expected = parse(file);
+    W::Ast::AstCache cache(directory);
+
+    SECTION("round trip") {
+        CHECK(!cache.load(file));
+        cache.store(expected);
+
+        std::optional<W::Ast::FlatTree> tree = cache.load(file);
+        REQUIRE(tree);
+        CHECK(tree->file() == file);
+        CHECK(tree->size() == expected.size());
+        REQUIRE(tree->roots().size() == expected.roots().size());
+        for (std::size_t i = 0; i < tree->roots().size(); i++)
+            CHECK(tree->roots()[i] == expected.roots()[i]);
+
+        using namespace W::Ast;
+        #define WLANG_AST(X, C) check_nodes<Flat::X##C>(expected, *tree);
+        #include <frontend/ast/node_list.hpp>
+
+        const Flat::DeclareFunctionStatement& function = tree->get<Flat::DeclareFunctionStatement>(tree->roots()[0]);
+        CHECK(W::SymbolTable::global().name(function.name) == "cached_function");
+        CHECK(W::SymbolTable::global().name(tree->parameters(function.parameters)[1].name) == "b");
+        CHECK(tree->nodes<Flat::FloatLiteral>()[0].value == 3.5);
+        CHECK(tree->string(tree->nodes<Flat::StringLiteral>()[0].value) == "a\tb");
+    }
+    SECTION("other sources") {
+        cache.store(expected);
+
+        static std::string edited = source + "d := 1\n";
+        W::FileId other = W::SourceManager::global().add("test.w", W::SourceBuffer::borrow(edited));
+        CHECK(!cache.load(other));
+
+        // same source under another path
+        W::FileId copy = W::SourceManager::global().add("copy.w", W::SourceBuffer::borrow(source));
+        CHECK(cache.load(copy));
+
+        CHECK(!W::Ast::AstCache(directory / "empty").load(file));
+    }
+    SECTION("broken files") {
+        cache.store(expected);
+        REQUIRE(std::distance(std::filesystem::directory_iterator(directory), {}) == 1);
+        std::filesystem::path path = std::filesystem::directory_iterator(directory)->path();
+        CHECK(path.extension() == ".ast");
+
+        std::filesystem::resize_file(path, std::filesystem::file_size(path) / 2);
+        CHECK(!cache.load(file));
+
+        std::ofstream(path, std::ios::binary) << "not a tree";
+        CHECK(!cache.load(file));
+
+        // stored again over it
+        cache.store(expected);
+        CHECK(cache.load(file));
+    }
+    SECTION("corrupted arrays") {
+        cache.store(expected);
+        std::filesystem::path path = std::filesystem::directory_iterator(directory)->path();
+        std::string image;
+        {
+            std::ifstream input(path, std::ios::binary);
+            image.assign(std::istreambuf_iterator<char>(input), {});
+        }
+
+        // a header of 32 bytes then the table of sections (offset and size),
+        // the roots are the first section
+        uint64_t roots;
+        std::memcpy(&roots, image.data() + 32, sizeof(roots));
+        auto corrupt = [&](W::Ast::NodeHandle root) {
+            std::string corrupted = image;
+            std::memcpy(corrupted.data() + roots, &root, sizeof(root));
+            std::ofstream(path, std::ios::binary) << corrupted;
+            return cache.load(file);
+        };
+
+        using namespace W::Ast;
+        CHECK(corrupt(expected.roots()[0]));
+        // out of its array, of no kind, shared by two roots
+        CHECK(!corrupt(NodeHandle::make(NodeType::BinaryExpression, 1000)));
+        CHECK(!corrupt(NodeHandle { ~uint32_t(0) }));
+        CHECK(!corrupt(expected.roots()[1]));
+        CHECK(!corrupt(NodeHandle()));
+    }
+
+    std::filesystem::remove_all(directory);
+}
@@ -0,0 +1,72 @@
+#include <filesystem>
+#include <fstream>
+#include <string>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <driver.hpp>
+
+TEST_CASE("driver") {
+    std::filesystem::path root = std::filesystem::temp_directory_path() / "w_driver_test";
+    std::filesystem::remove_all(root);
+    std::filesystem::create_directories(root / "nested");
+
+    for (int i = 0; i < 40; i++) {
+        std::ofstream output(root / (i % 2 ? "nested" : "") / ("m" + std::to_string(i) + ".w"));
+        output << "fn f(a int) int { b := a * 2 }\nconst c := 1\n";
+        // every fourth file has two errors
+        if (i % 4 == 0)
+            output << "d := (1 +\nconst mut e := 2\n";
+    }
+    std::ofstream(root / "ignored.txt") << "not a source file (\n";
+
+    SECTION("same diagnostics with any number of jobs") {
+        W::Driver sequential(W::Driver::Options { .jobs = 1 });
+        sequential.add(root);
+        CHECK(!sequential.run());
+        CHECK(sequential.files() == 40);
+        CHECK(sequential.statements() == 40 * 2 + 10);
+        REQUIRE(sequential.diagnostics().size() == 10 * 2);
+
+        for (unsigned jobs : { 2, 8, 64 }) {
+            W::Driver driver(W::Driver::Options { .jobs = jobs });
+            driver.add(root);
+            CHECK(!driver.run());
+
+            REQUIRE(driver.diagnostics().size() == sequential.diagnostics().size());
+            for (std::size_t i = 0; i < driver.diagnostics().size(); i++) {
+                auto expected = sequential.diagnostics().all()[i];
+                auto diagnostic = driver.diagnostics().all()[i];
+                CHECK(fmt::format("{}", expected.location) == fmt::format("{}", diagnostic.location));
+                CHECK(expected.message == diagnostic.message);
+            }
+        }
+    }
+    SECTION("empty file") {
+        std::ofstream(root / "nested" / "empty.w").close();
+
+        W::Driver single(W::Driver::Options { .jobs = 2 });
+        single.add(root / "nested" / "empty.w");
+        CHECK(single.run());
+        CHECK(single.statements() == 0);
+        CHECK(single.failures().empty());
+
+        W::Driver driver(W::Driver::Options { .jobs = 4 });
+        driver.add(root);
+        CHECK(!driver.run());
+        CHECK(driver.files() == 41);
+        CHECK(driver.statements() == 40 * 2 + 10);
+        CHECK(driver.failures().empty());
+    }
+    SECTION("missing file") {
+        W::Driver driver(W::Driver::Options { .jobs = 2 });
+        driver.add(root / "m2.w");
+        driver.add(root / "missing.w");
+        CHECK(!driver.run());
+        CHECK(driver.diagnostics().empty());
+        REQUIRE(driver.failures().size() == 1);
+        CHECK(driver.failures()[0].path == root / "missing.w");
+    }
+
+    std::filesystem::remove_all(root);
+}
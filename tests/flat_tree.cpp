@@ -0,0 +1,146 @@
+#include <map>
+#include <sstream>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <frontend/ast/flat_tree.hpp>
+#include <frontend/lexer.hpp>
+#include <frontend/parser.hpp>
+#include <frontend/token_stream.hpp>
+#include <passes/pass.hpp>
+#include <utils/arena.hpp>
+
+// the common expressions stay under 16 bytes, their location included
+static_assert(W::Ast::FlatTree::node_size<W::Ast::Flat::BinaryExpression>() < 16);
+static_assert(W::Ast::FlatTree::node_size<W::Ast::Flat::UnaryExpression>() < 16);
+static_assert(W::Ast::FlatTree::node_size<W::Ast::Flat::CallExpression>() < 16);
+static_assert(W::Ast::FlatTree::node_size<W::Ast::Flat::IdentExpression>() < 16);
+static_assert(W::Ast::FlatTree::node_size<W::Ast::Flat::IntLiteral>() < 16);
+
+// locations of the pointer nodes of every kind, in the order the builder
+// adds them to the flat tree
+struct LocationCollector : W::Passes::VisitorPass {
+    #define WLANG_AST(X, C) \
+        void visit(W::Ast::X##C& node) override { \
+            handle_children(node); \
+            locations[W::Ast::NodeType::X##C].push_back(node.location); \
+        }
+    #include <frontend/ast/node_list.hpp>
+
+    std::map<W::Ast::NodeType, std::vector<W::Location>> locations;
+};
+
+TEST_CASE("flat_tree") {
+    std::istringstream data(
+        "pub fn f(a int, mut b []int) int { c := g(a, -b).x }\n"
+        "(1 + 2) * 3.5\n"
+        "const s := \"a\\tb\"\n"
+    );
+    W::Lexer lexer("test.w", data);
+    W::TokenStream token_stream(lexer);
+    W::utils::Arena arena;
+    W::Diagnostics diagnostics;
+    W::Parser parser(token_stream, arena, diagnostics);
+
+    std::vector<W::Ast::StatementPtr> statements;
+    while (token_stream.peek().kind != W::TokenKind::Eof)
+        statements.push_back(parser.next());
+
+    W::Ast::FlatTree tree = W::Ast::FlatTree::build(token_stream.file(), statements);
+    REQUIRE(tree.roots().size() == 3);
+
+    SECTION("nodes") {
+        using namespace W::Ast;
+
+        REQUIRE(tree.roots()[0].type() == NodeType::DeclareFunctionStatement);
+        const Flat::DeclareFunctionStatement& function = tree.get<Flat::DeclareFunctionStatement>(tree.roots()[0]);
+        CHECK(function.is_pub);
+        CHECK(tree.raw(tree.roots()[0]).starts_with("fn f("));
+
+        auto parameters = tree.parameters(function.parameters);
+        REQUIRE(parameters.size() == 2);
+        CHECK(parameters[1].modifiers == VariableModifiers::Mutable);
+        CHECK(parameters[1].type.type() == NodeType::SliceTypeExpression);
+        CHECK(fmt::format("{}", tree.parameter_location(function.parameters, 1)) == "test.w:1:17");
+        CHECK(tree.raw(function.return_type) == "int");
+
+        auto body = tree.children(function.body);
+        REQUIRE(body.size() == 1);
+        const Flat::DeclareVariableStatement& declaration = tree.get<Flat::DeclareVariableStatement>(body[0]);
+        const Flat::AccessIdentifierExpression& access = tree.get<Flat::AccessIdentifierExpression>(declaration.value);
+        auto members = tree.children(access.members);
+        REQUIRE(members.size() == 2);
+        const Flat::CallExpression& call = tree.get<Flat::CallExpression>(members[0]);
+        CHECK(tree.children(call.params).size() == 2);
+        CHECK(tree.raw(members[0]) == "g(a, -b)");
+
+        const Flat::DeclareVariableStatement& constant = tree.get<Flat::DeclareVariableStatement>(tree.roots()[2]);
+        CHECK(constant.modifiers == VariableModifiers::Const);
+        CHECK(tree.string(tree.get<Flat::StringLiteral>(constant.value).value) == "a\tb");
+
+        const Flat::ExpressionStatement& expression = tree.get<Flat::ExpressionStatement>(tree.roots()[1]);
+        const Flat::BinaryExpression& product = tree.get<Flat::BinaryExpression>(expression.expr);
+        CHECK(product.op == BinaryOp::Multiply);
+        CHECK(product.left.type() == NodeType::ParentExpression);
+        CHECK(tree.get<Flat::FloatLiteral>(product.right).value == 3.5);
+        CHECK(tree.raw(product.right) == "3.5");
+        CHECK(fmt::format("{}", tree.location(product.right)) == "test.w:2:11");
+    }
+    SECTION("recovered locations") {
+        // brackets and commas inside comments, trailing commas, calls
+        // without arguments and nested brackets
+        std::istringstream brackets_data(
+            "f()[i /* ] */ ,] + (-(g(.A, 'r', [2]x, ) ))\n"
+            "h(a)(b)() * [](c.d[0])\n"
+        );
+        W::Lexer brackets_lexer("test.w", brackets_data);
+        W::TokenStream brackets_stream(brackets_lexer);
+        W::Parser brackets_parser(brackets_stream, arena, diagnostics);
+        while (brackets_stream.peek().kind != W::TokenKind::Eof)
+            statements.push_back(brackets_parser.next());
+        REQUIRE(diagnostics.empty());
+
+        // a tree per file, the statements of the first one come first
+        for (W::FileId file : { token_stream.file(), brackets_stream.file() }) {
+            std::span<W::Ast::StatementPtr> file_statements(statements);
+            file_statements = file == token_stream.file() ? file_statements.first(3) : file_statements.subspan(3);
+            W::Ast::FlatTree file_tree = W::Ast::FlatTree::build(file, file_statements);
+
+            LocationCollector collector;
+            collector.handle_statement(file_statements);
+            for (const auto& [type, locations] : collector.locations) {
+                for (std::size_t i = 0; i < locations.size(); i++) {
+                    W::Location location = file_tree.location(W::Ast::NodeHandle::make(type, static_cast<uint32_t>(i)));
+                    CHECK(location.begin == locations[i].begin);
+                    CHECK(location.end == locations[i].end);
+                }
+            }
+        }
+    }
+    SECTION("linear scans") {
+        using namespace W::Ast;
+
+        // children are stored before their parents
+        auto binaries = tree.nodes<Flat::BinaryExpression>();
+        REQUIRE(binaries.size() == 2);
+        CHECK(binaries[0].op == BinaryOp::Add);
+        CHECK(binaries[1].op == BinaryOp::Multiply);
+
+        int64_t sum = 0;
+        for (const Flat::IntLiteral& literal : tree.nodes<Flat::IntLiteral>())
+            sum += literal.value;
+        CHECK(sum == 3);
+
+        CHECK(tree.nodes<Flat::IdentExpression>().size() == 7);
+        CHECK(tree.size() == 22);
+
+        std::size_t statements = 0;
+        for (NodeHandle root : tree.roots()) {
+            statements += tree.visit(root, []<typename T>(const T&, NodeHandle) {
+                return std::is_same_v<T, Flat::DeclareVariableStatement> ? 1 : 0;
+            });
+        }
+        CHECK(statements == 1);
+    }
+}
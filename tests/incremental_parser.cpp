@@ -0,0 +1,171 @@
+#include <algorithm>
+#include <iterator>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <diagnostics.hpp>
+#include <frontend/ast/flat_tree.hpp>
+#include <frontend/incremental_parser.hpp>
+#include <frontend/lexer.hpp>
+#include <frontend/parser.hpp>
+#include <frontend/token_stream.hpp>
+#include <utils/arena.hpp>
+
+template<typename T>
+static void check_same_kind(const W::Ast::FlatTree& expected, const W::Ast::FlatTree& tree) {
+    REQUIRE(expected.nodes<T>().size() == tree.nodes<T>().size());
+    for (std::size_t i = 0; i < tree.nodes<T>().size(); i++) {
+        auto handle = W::Ast::NodeHandle::make(W::Ast::FlatTree::type_of<T>(), static_cast<uint32_t>(i));
+        CHECK(expected.raw(handle) == tree.raw(handle));
+    }
+}
+
+// compares with a parse of the whole edited file from scratch
+static void check_reparsed(const W::IncrementalParser& parser) {
+    std::string source(W::SourceManager::global().file(parser.file()).content());
+    std::istringstream data(source);
+    W::Lexer lexer("test.w", data);
+    W::TokenStream token_stream(lexer);
+    W::utils::Arena arena;
+    W::Diagnostics diagnostics;
+    W::Parser full(token_stream, arena, diagnostics);
+
+    std::vector<W::Ast::StatementPtr> statements;
+    while (token_stream.peek().kind != W::TokenKind::Eof) {
+        if (W::Ast::StatementPtr statement = full.next())
+            statements.push_back(statement);
+    }
+
+    // the raw source of every node is the same only if its location is
+    // right in the edited file
+    W::Ast::FlatTree expected = W::Ast::FlatTree::build(token_stream.file(), statements);
+    REQUIRE(parser.bases().size() == parser.statements().size());
+    W::Ast::FlatTree tree = W::Ast::FlatTree::build(parser.file(), parser.statements(), parser.bases());
+    REQUIRE(expected.roots().size() == tree.roots().size());
+    #define WLANG_AST(X, C) check_same_kind<W::Ast::Flat::X##C>(expected, tree);
+    #include <frontend/ast/node_list.hpp>
+
+    for (W::Ast::StatementPtr statement : parser.statements())
+        CHECK(statement->location.file == parser.file());
+
+    REQUIRE(diagnostics.size() == parser.diagnostics().size());
+    for (std::size_t i = 0; i < diagnostics.size(); i++) {
+        CHECK(parser.diagnostics()[i].location.file == parser.file());
+        CHECK(fmt::format("{}", parser.diagnostics()[i].location).ends_with(fmt::format("{}", diagnostics.all()[i].location).substr(6)));
+        CHECK(parser.diagnostics()[i].message == diagnostics.all()[i].message);
+    }
+}
+
+// compares the diagnostics with a new parser of the edited file, the
+// declarations are parsed alone by both
+static void check_same_diagnostics(const W::IncrementalParser& parser) {
+    std::istringstream data(std::string(W::SourceManager::global().file(parser.file()).content()));
+    W::IncrementalParser fresh(W::SourceManager::global().add("test.w", W::SourceBuffer::load(data)));
+
+    REQUIRE(fresh.diagnostics().size() == parser.diagnostics().size());
+    for (std::size_t i = 0; i < fresh.diagnostics().size(); i++) {
+        CHECK(parser.diagnostics()[i].location.begin == fresh.diagnostics()[i].location.begin);
+        CHECK(parser.diagnostics()[i].location.end == fresh.diagnostics()[i].location.end);
+        CHECK(parser.diagnostics()[i].message == fresh.diagnostics()[i].message);
+    }
+}
+
+TEST_CASE("incremental_parser") {
+    std::string source;
+    for (int i = 0; i < 50; i++) {
+        std::string n = std::to_string(i);
+        source += "fn f" + n + "(a int) int {\n    b := g(a, " + n + ")\n}\nconst c" + n + " := \"s\" + 1.5\n";
+    }
+    std::istringstream input(source);
+    W::FileId file = W::SourceManager::global().add("test.w", W::SourceBuffer::load(input));
+    W::IncrementalParser parser(file);
+    check_reparsed(parser);
+    REQUIRE(parser.statements().size() == 100);
+
+    uint32_t middle = static_cast<uint32_t>(source.find("g(a, 25)"));
+
+    SECTION("edit inside a declaration") {
+        parser.edit(W::TextEdit { middle + 5, 2, "(1 + 2) * 7" });
+        check_reparsed(parser);
+        CHECK(parser.reused() == 99);
+    }
+    SECTION("new declaration") {
+        W::Ast::StatementPtr last = parser.statements().back();
+        W::Location location = last->location;
+        uint32_t base = parser.bases().back();
+
+        parser.edit(W::TextEdit { 0, 0, "x := 1\n" });
+        check_reparsed(parser);
+        CHECK(parser.reused() == 100);
+        CHECK(parser.statements().size() == 101);
+
+        // a reused declaration moves without touching its nodes
+        CHECK(parser.statements().back() == last);
+        CHECK(last->location.begin == location.begin);
+        CHECK(parser.bases().back() == base + 7);
+    }
+    SECTION("errors come and go") {
+        parser.edit(W::TextEdit { middle, 0, "] " });
+        check_reparsed(parser);
+        CHECK(parser.diagnostics().size() == 1);
+        CHECK(parser.reused() == 99);
+
+        parser.edit(W::TextEdit { middle, 2, "" });
+        check_reparsed(parser);
+        CHECK(parser.diagnostics().empty());
+    }
+    SECTION("unbalanced brace") {
+        // every declaration after it is nested in the function
+        parser.edit(W::TextEdit { middle, 0, "{ " });
+        check_reparsed(parser);
+
+        parser.edit(W::TextEdit { middle, 2, "" });
+        check_reparsed(parser);
+    }
+    SECTION("errors at the end of a declaration") {
+        // the unexpected eof of x is at fn, it moves with the blank lines
+        std::istringstream data("x := 1 +\n\nfn g() {}\n");
+        W::IncrementalParser gap(W::SourceManager::global().add("test.w", W::SourceBuffer::load(data)));
+        REQUIRE(gap.diagnostics().size() == 1);
+        CHECK(gap.diagnostics()[0].location.begin == 10);
+
+        gap.edit(W::TextEdit { 9, 0, "\n\n\n" });
+        check_same_diagnostics(gap);
+        REQUIRE(gap.diagnostics().size() == 1);
+        CHECK(gap.diagnostics()[0].location.begin == 13);
+        CHECK(gap.reused() == 1);
+
+        // random edits of a file with errors
+        std::string_view pieces[] = { "", "\n", " ", "+", "(", ")", "{", "}", "x := 1", "fn h() {", "const" };
+        uint32_t seed = 3;
+        auto random = [&seed](uint32_t bound) {
+            seed = seed * 1103515245 + 12345;
+            return (seed >> 16) % bound;
+        };
+        for (int i = 0; i < 300; i++) {
+            auto size = static_cast<uint32_t>(W::SourceManager::global().file(gap.file()).content().size());
+            uint32_t offset = random(size + 1);
+            uint32_t removed = random(std::min<uint32_t>(3, size - offset) + 1);
+            gap.edit(W::TextEdit { offset, removed, pieces[random(std::size(pieces))] });
+            check_same_diagnostics(gap);
+        }
+    }
+    SECTION("many edits") {
+        // the arena is replaced once the replaced nodes pile up, everything
+        // is parsed again then
+        int rebuilds = 0;
+        for (int i = 0; i < 300; i++) {
+            parser.edit(W::TextEdit { middle + 5, 2, i % 2 ? "25" : "52" });
+            if (parser.reused() == 0)
+                rebuilds++;
+            else
+                CHECK(parser.reused() == 99);
+        }
+        check_reparsed(parser);
+        CHECK(rebuilds > 0);
+        CHECK(rebuilds < 10);
+    }
+}
@@ -1,11 +1,20 @@
+#include <memory>
+#include <optional>
+#include <thread>
 #include <variant>
 #include <utility>
 #include <sstream>
 #include <vector>
 
+#include <unistd.h>
+
 #include <catch2/catch_test_macros.hpp>
 
 #include <frontend/lexer.hpp>
+#include <frontend/scanners.hpp>
+#include <frontend/source_buffer.hpp>
+#include <frontend/stream_reader.hpp>
+#include <frontend/token_buffer.hpp>
 #include <utils/types.hpp>
 
 TEST_CASE("lexing") {
@@ -25,7 +34,7 @@ TEST_CASE("lexing") {
             W::Token token = lexer.next();
 
             CHECK(expected.first == token.kind);
-            CHECK(expected.second == token.raw);
+            CHECK(expected.second == lexer.raw(token));
         }
 
         W::Token token = lexer.next();
@@ -91,7 +100,7 @@ TEST_CASE("lexing") {
 
         W::Token token1 = lexer.next();
         CHECK(W::TokenKind::Ident == token1.kind);
-        CHECK("test1" == token1.raw);
+        CHECK("test1" == lexer.raw(token1));
 
         W::Token token = lexer.next();
         CHECK(W::TokenKind::Eof == token.kind);
@@ -170,4 +179,279 @@ TEST_CASE("lexing") {
         W::Token token = lexer.next();
         CHECK(W::TokenKind::Eof == token.kind);
     }
+
+    SECTION("glued operators") {
+        std::istringstream data("a>>>=b>>>>=c!inc...=$d");
+        W::Lexer lexer("test.w", data);
+
+        std::pair<W::TokenKind, std::string> expecteds[] = {
+            {W::TokenKind::Ident, "a"},
+            {W::TokenKind::UnsignedRightShiftAssign, ""},
+            {W::TokenKind::Ident, "b"},
+            {W::TokenKind::UnsignedRightShift, ""},
+            {W::TokenKind::Ge, ""},
+            {W::TokenKind::Ident, "c"},
+            {W::TokenKind::NotIn, ""},
+            {W::TokenKind::Ident, "c"},
+            {W::TokenKind::Ellipsis, ""},
+            {W::TokenKind::Assign, ""},
+            {W::TokenKind::Unknown, ""},
+            {W::TokenKind::Ident, "d"},
+        };
+        for (auto expected : expecteds) {
+            W::Token token = lexer.next();
+
+            CHECK(expected.first == token.kind);
+            CHECK(expected.second == lexer.raw(token));
+        }
+
+        W::Token token = lexer.next();
+        CHECK(token.kind == W::TokenKind::Eof);
+    }
+
+    SECTION("source buffer") {
+        std::string_view source = "fn main() { print('hello') } // end";
+        W::Lexer lexer("test.w", W::SourceBuffer::borrow(source));
+
+        std::pair<W::TokenKind, std::string_view> expecteds[] = {
+            {W::TokenKind::KeyFn, ""},
+            {W::TokenKind::Ident, "main"},
+            {W::TokenKind::Lpar, ""},
+            {W::TokenKind::Rpar, ""},
+            {W::TokenKind::Lcbr, ""},
+            {W::TokenKind::Ident, "print"},
+            {W::TokenKind::Lpar, ""},
+            {W::TokenKind::String, "hello"},
+            {W::TokenKind::Rpar, ""},
+            {W::TokenKind::Rcbr, ""},
+        };
+        for (auto expected : expecteds) {
+            W::Token token = lexer.next();
+
+            CHECK(expected.first == token.kind);
+            CHECK(expected.second == lexer.raw(token));
+            // the raw value is a view into the source, not a copy
+            if (!lexer.raw(token).empty()) {
+                CHECK(lexer.raw(token).data() >= source.data());
+                CHECK(lexer.raw(token).data() < source.data() + source.size());
+            }
+        }
+
+        W::Token token = lexer.next();
+        CHECK(token.kind == W::TokenKind::Eof);
+    }
+
+    SECTION("locations") {
+        std::istringstream data("first\n  second /* a\nb */ third");
+        W::Lexer lexer("test.w", data);
+        const W::SourceFile& file = W::SourceManager::global().file(lexer.file());
+
+        W::Token first = lexer.next();
+        W::Token second = lexer.next();
+        W::Token third = lexer.next();
+
+        W::Location location = lexer.location(first);
+        CHECK(location.begin == 0);
+        CHECK(location.end == 5);
+        CHECK(file.line_column(location.begin).line == 1);
+        CHECK(file.line_column(location.begin).column == 1);
+        CHECK(file.line_column(location.end).column == 6);
+
+        location = lexer.location(second);
+        CHECK(file.line_column(location.begin).line == 2);
+        CHECK(file.line_column(location.begin).column == 3);
+        CHECK(file.line_column(location.end).column == 9);
+
+        location = lexer.location(third);
+        CHECK(file.line_column(location.begin).line == 3);
+        CHECK(file.line_column(location.begin).column == 6);
+        CHECK(fmt::format("{}", location) == "test.w:3:6");
+
+        location = W::Location::merge(lexer.location(first), location);
+        CHECK(fmt::format("{}", location) == "test.w:1:1");
+        CHECK(location.end == third.offset + third.length);
+    }
+    SECTION("edits") {
+        std::istringstream data("first\nsecond");
+        W::FileId id = W::Lexer("test.w", data).file();
+        const W::SourceFile& file = W::SourceManager::global().file(id);
+        CHECK(file.line_column(7).line == 2);
+
+        // in place while nothing holds the content
+        const char* data_before = file.content().data();
+        W::SourceManager::global().edit(id, W::TextEdit { 5, 1, " " });
+        CHECK(file.content() == "first second");
+        CHECK(file.content().data() == data_before);
+        CHECK(file.line_column(7).line == 1);
+
+        // a snapshot keeps its version, the file is copied
+        std::shared_ptr<const W::SourceBuffer> snapshot = file.snapshot();
+        W::SourceManager::global().edit(id, W::TextEdit { 0, 5, "1st\n" });
+        CHECK(snapshot->view() == "first second");
+        CHECK(file.content() == "1st\n second");
+        CHECK(file.content().data() != snapshot->data());
+        CHECK(file.line_column(5).line == 2);
+    }
+    SECTION("numeric literals") {
+        std::istringstream data(
+            "1_000 0x_ff 0XFF 0o17 0b1010 1.5e3 2e-2 0.25 1..2 "
+            "18446744073709551615 18446744073709551616 1e999 12abc 0x 0b102"
+        );
+        W::Lexer lexer("test.w", data);
+        W::LiteralTable& literals = W::LiteralTable::global();
+
+        for (uint64_t expected : { 1000, 0xff, 0xff, 017, 0b1010 }) {
+            W::Token token = lexer.next();
+            CHECK(token.kind == W::TokenKind::Integer);
+            CHECK(literals.integer(token.literal()) == expected);
+        }
+        for (double expected : { 1500.0, 0.02, 0.25 }) {
+            W::Token token = lexer.next();
+            CHECK(token.kind == W::TokenKind::Float);
+            CHECK(literals.floating(token.literal()) == expected);
+        }
+
+        // a range, not a float
+        CHECK(literals.integer(lexer.next().literal()) == 1);
+        CHECK(lexer.next().kind == W::TokenKind::Dotdot);
+        CHECK(literals.integer(lexer.next().literal()) == 2);
+
+        CHECK(literals.integer(lexer.next().literal()) == UINT64_MAX);
+        CHECK(lexer.next().literal() == W::LiteralId::OutOfRange);
+        CHECK(lexer.next().literal() == W::LiteralId::OutOfRange);
+
+        for (std::string_view expected : { "12abc", "0x", "0b102" }) {
+            W::Token token = lexer.next();
+            CHECK(token.kind == W::TokenKind::Integer);
+            CHECK(token.literal() == W::LiteralId::Invalid);
+            CHECK(lexer.raw(token) == expected);
+        }
+        CHECK(lexer.next().kind == W::TokenKind::Eof);
+    }
+    SECTION("string escapes") {
+        std::istringstream data(
+            "\"plain\" \"a\\tb\\\\c\\\"d\" 'it\\'s' `\\n` \"\\x41\\u{e9}\\u{1F600}\" "
+            "\"\\q\" \"\\x4\" \"\\u{d800}\" \"end\\\\\""
+        );
+        W::Lexer lexer("test.w", data);
+        W::LiteralTable& literals = W::LiteralTable::global();
+
+        // strings without escape are views into the source
+        W::Token token = lexer.next();
+        CHECK(token.literal() == W::LiteralId::Raw);
+        CHECK(literals.string(token.literal(), lexer.raw(token)) == "plain");
+
+        std::string_view expecteds[] = { "a\tb\\c\"d", "it's", "\n", "A\u00e9\U0001F600" };
+        for (std::string_view expected : expecteds) {
+            token = lexer.next();
+            CHECK(token.literal() != W::LiteralId::Raw);
+            CHECK(literals.string(token.literal(), lexer.raw(token)) == expected);
+        }
+
+        for (int i = 0; i < 3; i++)
+            CHECK(lexer.next().literal() == W::LiteralId::Invalid);
+
+        token = lexer.next();
+        CHECK(token.kind == W::TokenKind::String);
+        CHECK(literals.string(token.literal(), lexer.raw(token)) == "end\\");
+        CHECK(lexer.next().kind == W::TokenKind::Eof);
+    }
+    SECTION("utf-8 validation") {
+        std::istringstream valid("s := \"héllo \U0001F600\"");
+        std::istringstream invalid("s := \"bad \xff byte\"");
+
+        CHECK(!W::SourceManager::global().file(W::Lexer("test.w", valid).file()).invalid_utf8());
+        CHECK(W::SourceManager::global().file(W::Lexer("test.w", invalid).file()).invalid_utf8() == 10);
+    }
+    SECTION("stream") {
+        // tokens, strings and a comment bigger than a chunk straddle the
+        // refills
+        std::string source;
+        for (int i = 0; i < 4000; i++)
+            source += "fn f(a: int) { return a >>= 0x_ff + \"text\" } ident_" + std::to_string(i) + "\n";
+        source += "/* " + std::string(200 * 1024, '*') + " */ last";
+
+        std::istringstream data(source);
+        W::TokenBuffer expected = W::Lexer("test.w", data).lex_all();
+
+        auto check_tokens = [&](const W::TokenBuffer& tokens) {
+            CHECK(W::SourceManager::global().file(tokens.file()).content() == source);
+            REQUIRE(tokens.size() == expected.size());
+            for (std::size_t i = 0; i < expected.size(); i++) {
+                CHECK(tokens.kinds()[i] == expected.kinds()[i]);
+                CHECK(tokens.offsets()[i] == expected.offsets()[i]);
+                CHECK(tokens.lengths()[i] == expected.lengths()[i]);
+                CHECK(tokens.payloads()[i] == expected.payloads()[i]);
+            }
+        };
+
+        std::istringstream stream(source);
+        W::StreamReader reader(stream, W::StreamReader::s_min_chunk_size);
+        check_tokens(W::Lexer::lex_stream("test.w", reader));
+
+        // a pipe returns partial reads
+        int fds[2];
+        REQUIRE(pipe(fds) == 0);
+        bool written = true;
+        std::thread writer([&] {
+            for (std::size_t i = 0; i < source.size(); i += 1000)
+                written &= write(fds[1], source.data() + i, std::min<std::size_t>(1000, source.size() - i)) > 0;
+            close(fds[1]);
+        });
+        W::StreamReader pipe_reader(fds[0], W::StreamReader::s_min_chunk_size);
+        check_tokens(W::Lexer::lex_stream("test.w", pipe_reader));
+        writer.join();
+        close(fds[0]);
+        CHECK(written);
+    }
+    SECTION("relex") {
+        std::istringstream data(
+            "fn main() { a >>= 1 /* x */ }\n"
+            "s := \"text\" + `r` // comment\n"
+            "b := a... 0.5 /* outer /* inner */ */ c\n"
+        );
+        W::FileId file = W::SourceManager::global().add("test.w", W::SourceBuffer::load(data));
+        W::TokenBuffer tokens = W::Lexer(file).lex_all();
+
+        // every edit has to give the tokens of a full lex of the edited file,
+        // the pieces open or close strings and comments and glue operators,
+        // split or complete UTF-8 sequences
+        std::string_view pieces[] = {
+            "", ">", "=", "x", " ", "\"", "`", "/*", "*/", "//", "\n", ".",
+            "\xc3\xa9", "\xc3", "\xa9", "\xe2\x82", "\xac", "\xff",
+        };
+        uint32_t seed = 42;
+        auto random = [&seed](uint32_t bound) {
+            seed = seed * 1103515245 + 12345;
+            return (seed >> 16) % bound;
+        };
+
+        for (int i = 0; i < 500; i++) {
+            std::string_view source = W::SourceManager::global().file(file).content();
+            uint32_t offset = random(static_cast<uint32_t>(source.size()) + 1);
+            uint32_t removed = random(std::min<uint32_t>(4, static_cast<uint32_t>(source.size()) - offset) + 1);
+            W::TextEdit edit = { offset, removed, pieces[random(std::size(pieces))] };
+
+            W::SourceManager::global().edit(file, edit);
+            W::Lexer::relex(tokens, file, edit);
+            W::TokenBuffer expected = W::Lexer(file).lex_all();
+
+            // only the bytes around the edit are checked again
+            const W::SourceFile& edited = W::SourceManager::global().file(file);
+            const char* begin = edited.content().data();
+            const char* end = begin + edited.content().size();
+            const char* invalid = W::Scanners::validate_utf8(begin, end);
+            CHECK(edited.invalid_utf8() == (invalid != end ? std::optional<uint32_t>(static_cast<uint32_t>(invalid - begin)) : std::nullopt));
+
+            CHECK(tokens.file() == file);
+            CHECK(tokens.source() == edited.content());
+            REQUIRE(tokens.size() == expected.size());
+            for (std::size_t j = 0; j < expected.size(); j++) {
+                CHECK(tokens.kinds()[j] == expected.kinds()[j]);
+                CHECK(tokens.offsets()[j] == expected.offsets()[j]);
+                CHECK(tokens.lengths()[j] == expected.lengths()[j]);
+                CHECK(tokens.payloads()[j] == expected.payloads()[j]);
+            }
+        }
+    }
 }
@@ -0,0 +1,80 @@
+#include <sstream>
+#include <string>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <frontend/lexer.hpp>
+#include <frontend/parallel_lexer.hpp>
+#include <frontend/token_buffer.hpp>
+
+static void check_same_tokens(const W::TokenBuffer& expected, const W::TokenBuffer& tokens) {
+    REQUIRE(expected.size() == tokens.size());
+    for (std::size_t i = 0; i < expected.size(); i++) {
+        CHECK(expected.kinds()[i] == tokens.kinds()[i]);
+        CHECK(expected.offsets()[i] == tokens.offsets()[i]);
+        CHECK(expected.lengths()[i] == tokens.lengths()[i]);
+        CHECK(expected.payloads()[i] == tokens.payloads()[i]);
+    }
+}
+
+TEST_CASE("parallel_lexer") {
+    // every line is a trap for a chunk starting right after it: multiline
+    // strings and runes, nested comments holding code and quotes
+    std::string source;
+    for (int i = 0; i < 64; i++) {
+        source += "fn f" + std::to_string(i) + "(a: int) { return a << 2 >>= 3 }\n";
+        source += "s := \"first line\nlet x = 'not code' /* still a string\n*/ end\"\n";
+        source += "/* outer\nfn fake() { \"\n/* inner\n*/ x := 1\n*/ y := `r`\n";
+        source += "// line comment with /* and \" inside\n";
+        source += "r := `\n` + 'multi\nline' */ 42.5\n";
+    }
+
+    std::istringstream input(source);
+    W::FileId file = W::SourceManager::global().add("test.w", W::SourceBuffer::load(input));
+    W::TokenBuffer expected = W::Lexer(file).lex_all();
+
+    SECTION("same tokens as the sequential lexer") {
+        for (std::size_t chunk_size : { 16, 61, 97, 256, 1000 }) {
+            W::ParallelLexer lexer(file, W::ParallelLexer::Options {
+                .threshold = 0,
+                .min_chunk_size = chunk_size,
+                .threads = 64,
+            });
+
+            check_same_tokens(expected, lexer.lex_all());
+        }
+    }
+    SECTION("on a shared pool") {
+        W::utils::ThreadPool pool(3);
+        for (std::size_t chunk_size : { 61, 256 }) {
+            W::ParallelLexer lexer(file, W::ParallelLexer::Options {
+                .threshold = 0,
+                .min_chunk_size = chunk_size,
+                .pool = &pool,
+            });
+
+            check_same_tokens(expected, lexer.lex_all());
+        }
+    }
+    SECTION("under the threshold") {
+        W::ParallelLexer lexer(file, W::ParallelLexer::Options {
+            .threshold = source.size() + 1,
+        });
+
+        check_same_tokens(expected, lexer.lex_all());
+    }
+    SECTION("unterminated string") {
+        std::istringstream unterminated(source + "\"never closed\nfn main() {}\n");
+        W::FileId unterminated_file = W::SourceManager::global().add("test.w", W::SourceBuffer::load(unterminated));
+        W::TokenBuffer unterminated_expected = W::Lexer(unterminated_file).lex_all();
+
+        W::ParallelLexer lexer(unterminated_file, W::ParallelLexer::Options {
+            .threshold = 0,
+            .min_chunk_size = 128,
+            .threads = 16,
+        });
+
+        check_same_tokens(unterminated_expected, lexer.lex_all());
+        CHECK(unterminated_expected[unterminated_expected.size() - 2].kind == W::TokenKind::Unknown);
+    }
+}
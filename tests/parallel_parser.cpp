@@ -0,0 +1,181 @@
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <diagnostics.hpp>
+#include <frontend/ast/flat_tree.hpp>
+#include <frontend/lexer.hpp>
+#include <frontend/parallel_parser.hpp>
+#include <frontend/parser.hpp>
+#include <frontend/token_stream.hpp>
+#include <utils/arena.hpp>
+
+template<typename T>
+static void check_same_kind(const W::Ast::FlatTree& expected, const W::Ast::FlatTree& tree) {
+    REQUIRE(expected.nodes<T>().size() == tree.nodes<T>().size());
+    for (std::size_t i = 0; i < tree.nodes<T>().size(); i++) {
+        auto handle = W::Ast::NodeHandle::make(W::Ast::FlatTree::type_of<T>(), static_cast<uint32_t>(i));
+        CHECK(expected.location(handle).begin == tree.location(handle).begin);
+        CHECK(expected.location(handle).end == tree.location(handle).end);
+    }
+}
+
+// the trees are built in the same order, the same AST gives the same nodes
+// at the same handles
+static void check_same_tree(const W::Ast::FlatTree& expected, const W::Ast::FlatTree& tree) {
+    REQUIRE(expected.roots().size() == tree.roots().size());
+    for (std::size_t i = 0; i < tree.roots().size(); i++)
+        CHECK(expected.roots()[i] == tree.roots()[i]);
+
+    #define WLANG_AST(X, C) check_same_kind<W::Ast::Flat::X##C>(expected, tree);
+    #include <frontend/ast/node_list.hpp>
+}
+
+static void check_same_diagnostics(const W::Diagnostics& expected, const W::Diagnostics& diagnostics) {
+    REQUIRE(expected.size() == diagnostics.size());
+    for (std::size_t i = 0; i < diagnostics.size(); i++) {
+        CHECK(expected.all()[i].type == diagnostics.all()[i].type);
+        CHECK(expected.all()[i].location.begin == diagnostics.all()[i].location.begin);
+        CHECK(expected.all()[i].message == diagnostics.all()[i].message);
+    }
+}
+
+static std::vector<W::Ast::StatementPtr> parse_sequential(const W::TokenBuffer& tokens, W::utils::Arena& arena, W::Diagnostics& diagnostics) {
+    W::TokenStream token_stream(tokens);
+    W::Parser parser(token_stream, arena, diagnostics);
+
+    std::vector<W::Ast::StatementPtr> statements;
+    while (token_stream.peek().kind != W::TokenKind::Eof) {
+        if (W::Ast::StatementPtr statement = parser.next())
+            statements.push_back(statement);
+    }
+    return statements;
+}
+
+TEST_CASE("parallel_parser") {
+    std::string source;
+    for (int i = 0; i < 64; i++) {
+        std::string n = std::to_string(i);
+        source += "pub fn f" + n + "(a int, mut b []int) int {\n    c := g(a,\n        -b).x\n    const d := [2]int\n}\n";
+        source += "type k" + n + " := (1 +\n    2) * 3.5\n";
+        source += "call(x.y, \"fn const\")\nv := x.w\n";
+        source += "static volatile mut s" + n + " := `r` + 0x1f\n";
+    }
+
+    std::istringstream input(source);
+    W::FileId file = W::SourceManager::global().add("test.w", W::SourceBuffer::load(input));
+    W::TokenBuffer tokens = W::Lexer(file).lex_all();
+
+    SECTION("boundaries") {
+        std::vector<std::size_t> boundaries = W::ParallelParser::boundaries(tokens);
+        // fn, type, v := and static of every iteration
+        REQUIRE(boundaries.size() == 64 * 4);
+        CHECK(tokens.kinds()[boundaries[0]] == W::TokenKind::KeyPub);
+        CHECK(tokens.kinds()[boundaries[1]] == W::TokenKind::KeyType);
+        CHECK(tokens.kinds()[boundaries[2]] == W::TokenKind::Ident);
+        CHECK(tokens.kinds()[boundaries[3]] == W::TokenKind::KeyStatic);
+    }
+    SECTION("same AST as the sequential parser") {
+        W::utils::Arena expected_arena;
+        W::Diagnostics expected_diagnostics;
+        W::Ast::FlatTree expected = W::Ast::FlatTree::build(file, parse_sequential(tokens, expected_arena, expected_diagnostics));
+        REQUIRE(expected_diagnostics.empty());
+
+        for (std::size_t chunk_size : { 1, 7, 100, 1000, 100000 }) {
+            W::utils::Arena arena;
+            W::Diagnostics diagnostics;
+            W::ParallelParser parser(tokens, W::ParallelParser::Options {
+                .threshold = 0,
+                .min_chunk_size = chunk_size,
+                .threads = 16,
+            });
+
+            check_same_tree(expected, W::Ast::FlatTree::build(file, parser.parse_all(arena, diagnostics)));
+            CHECK(diagnostics.empty());
+        }
+    }
+    SECTION("on a shared pool") {
+        W::utils::Arena expected_arena;
+        W::Diagnostics expected_diagnostics;
+        W::Ast::FlatTree expected = W::Ast::FlatTree::build(file, parse_sequential(tokens, expected_arena, expected_diagnostics));
+
+        W::utils::ThreadPool pool(3);
+        W::utils::Arena arena;
+        W::Diagnostics diagnostics;
+        W::ParallelParser parser(tokens, W::ParallelParser::Options {
+            .threshold = 0,
+            .min_chunk_size = 7,
+            .pool = &pool,
+        });
+
+        check_same_tree(expected, W::Ast::FlatTree::build(file, parser.parse_all(arena, diagnostics)));
+        CHECK(diagnostics.empty());
+    }
+    SECTION("errors") {
+        std::istringstream broken(source + "fn e() { a := (1 + }\nconst mut z := 0x\n" + source);
+        W::FileId broken_file = W::SourceManager::global().add("test.w", W::SourceBuffer::load(broken));
+        W::TokenBuffer broken_tokens = W::Lexer(broken_file).lex_all();
+
+        W::utils::Arena expected_arena;
+        W::Diagnostics expected_diagnostics;
+        W::Ast::FlatTree expected = W::Ast::FlatTree::build(broken_file, parse_sequential(broken_tokens, expected_arena, expected_diagnostics));
+        CHECK(expected_diagnostics.size() == 3);
+
+        W::utils::Arena arena;
+        W::Diagnostics diagnostics;
+        W::ParallelParser parser(broken_tokens, W::ParallelParser::Options {
+            .threshold = 0,
+            .min_chunk_size = 100,
+            .threads = 16,
+        });
+
+        check_same_tree(expected, W::Ast::FlatTree::build(broken_file, parser.parse_all(arena, diagnostics)));
+        check_same_diagnostics(expected_diagnostics, diagnostics);
+
+        // the recovery of an error skips boundaries, as in `)x := +` where
+        // the Parser skips the declaration of x
+        std::string_view fragments[] = {
+            ")", "(", "]", "{", "}", "x", "a.b", ":=", "1", "+", "\n", " ", ",",
+            "fn g()", "const", "mut", "pub", "type", "\"s\"", "x := 1", "call(",
+        };
+        uint32_t seed = 7;
+        auto random = [&seed](uint32_t bound) {
+            seed = seed * 1103515245 + 12345;
+            return (seed >> 16) % bound;
+        };
+
+        std::vector<std::string> inputs = { ":=x := 1 +\na.b := 3", ")x := +" };
+        for (int i = 0; i < 1000; i++) {
+            std::string input;
+            for (uint32_t j = random(40); j > 0; j--)
+                input += std::string(fragments[random(std::size(fragments))]) + (random(3) == 0 ? "\n" : " ");
+            inputs.push_back(input);
+        }
+
+        for (const std::string& input : inputs) {
+            std::istringstream data(input);
+            W::FileId fuzzed_file = W::SourceManager::global().add("test.w", W::SourceBuffer::load(data));
+            W::TokenBuffer fuzzed_tokens = W::Lexer(fuzzed_file).lex_all();
+
+            W::utils::Arena fuzzed_expected_arena;
+            W::Diagnostics fuzzed_expected_diagnostics;
+            W::Ast::FlatTree fuzzed_expected = W::Ast::FlatTree::build(fuzzed_file, parse_sequential(fuzzed_tokens, fuzzed_expected_arena, fuzzed_expected_diagnostics));
+
+            for (std::size_t chunk_size : { 1, 3 }) {
+                W::utils::Arena fuzzed_arena;
+                W::Diagnostics fuzzed_diagnostics;
+                W::ParallelParser fuzzed_parser(fuzzed_tokens, W::ParallelParser::Options {
+                    .threshold = 0,
+                    .min_chunk_size = chunk_size,
+                    .threads = 16,
+                });
+
+                INFO(input);
+                check_same_tree(fuzzed_expected, W::Ast::FlatTree::build(fuzzed_file, fuzzed_parser.parse_all(fuzzed_arena, fuzzed_diagnostics)));
+                check_same_diagnostics(fuzzed_expected_diagnostics, fuzzed_diagnostics);
+            }
+        }
+    }
+}
@@ -0,0 +1,174 @@
+#include <sstream>
+#include <string>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <diagnostics.hpp>
+#include <errors.hpp>
+#include <frontend/ast/flat_tree.hpp>
+#include <frontend/lexer.hpp>
+#include <frontend/parser.hpp>
+#include <frontend/token_buffer.hpp>
+#include <frontend/token_stream.hpp>
+#include <utils/arena.hpp>
+
+// parses a single expression statement
+static W::Ast::ExpressionPtr parse(W::utils::Arena& arena, const std::string& source) {
+    std::istringstream data(source);
+    W::Lexer lexer("test.w", data);
+    W::TokenStream token_stream(lexer);
+    W::Diagnostics diagnostics;
+    W::Parser parser(token_stream, arena, diagnostics);
+
+    auto statement = static_cast<W::Ast::ExpressionStatement*>(parser.next());
+    REQUIRE(diagnostics.empty());
+    REQUIRE(token_stream.peek().kind == W::TokenKind::Eof);
+    return statement->expr;
+}
+
+// parses the whole source, the statements with an error are not counted
+static std::size_t parse_all(W::utils::Arena& arena, const std::string& source, W::Diagnostics& diagnostics) {
+    std::istringstream data(source);
+    W::Lexer lexer("test.w", data);
+    W::TokenStream token_stream(lexer);
+    W::Parser parser(token_stream, arena, diagnostics);
+
+    std::size_t count = 0;
+    while (token_stream.peek().kind != W::TokenKind::Eof) {
+        if (parser.next() != nullptr)
+            count++;
+    }
+    return count;
+}
+
+// prints the expression with every binary operation parenthesized
+static std::string shape(W::Ast::ExpressionPtr expr) {
+    switch (expr->get_type()) {
+        case W::Ast::NodeType::BinaryExpression: {
+            auto binary = static_cast<W::Ast::BinaryExpression*>(expr);
+            return "(" + shape(binary->left) + " " + std::to_string(static_cast<int>(binary->op)) + " " + shape(binary->right) + ")";
+        }
+        case W::Ast::NodeType::UnaryExpression:
+            return "u" + shape(static_cast<W::Ast::UnaryExpression*>(expr)->expr);
+        case W::Ast::NodeType::ParentExpression:
+            return shape(static_cast<W::Ast::ParentExpression*>(expr)->expr);
+        case W::Ast::NodeType::IntLiteral:
+            return std::to_string(static_cast<W::Ast::IntLiteral*>(expr)->value);
+        default:
+            return "?";
+    }
+}
+
+TEST_CASE("parser") {
+    W::utils::Arena arena;
+    auto add = std::to_string(static_cast<int>(W::Ast::BinaryOp::Add));
+    auto sub = std::to_string(static_cast<int>(W::Ast::BinaryOp::Subtract));
+    auto mul = std::to_string(static_cast<int>(W::Ast::BinaryOp::Multiply));
+    auto lt = std::to_string(static_cast<int>(W::Ast::BinaryOp::CompLt));
+
+    SECTION("precedence") {
+        CHECK(shape(parse(arena, "1 - 2 - 3")) == "((1 " + sub + " 2) " + sub + " 3)");
+        CHECK(shape(parse(arena, "1 + 2 * 3 - 4")) == "((1 " + add + " (2 " + mul + " 3)) " + sub + " 4)");
+        CHECK(shape(parse(arena, "1 * 2 + 3 < 4")) == "(((1 " + mul + " 2) " + add + " 3) " + lt + " 4)");
+        CHECK(shape(parse(arena, "-1 * (2 + 3)")) == "(u1 " + mul + " (2 " + add + " 3))");
+        CHECK(fmt::format("{}", parse(arena, "  1 + 2 * 3")->location) == "test.w:1:3");
+    }
+    SECTION("long chains") {
+        // none of these recurses once per operator
+        std::string prefixes;
+        for (int i = 0; i < 100000; i++)
+            prefixes += "- ";
+        auto unary = parse(arena, prefixes + "1");
+        CHECK(unary->get_type() == W::Ast::NodeType::UnaryExpression);
+        CHECK(unary->location.end == prefixes.size() + 1);
+
+        std::string members = "a";
+        for (int i = 0; i < 100000; i++)
+            members += ".b(1)";
+        CHECK(parse(arena, members)->get_type() == W::Ast::NodeType::CallExpression);
+
+        std::string sum = "1";
+        for (int i = 0; i < 100000; i++)
+            sum += " + 1";
+        CHECK(parse(arena, sum)->location.end == sum.size());
+    }
+    SECTION("nesting limit") {
+        std::size_t depth = W::Parser::s_max_depth - 1;
+        CHECK(shape(parse(arena, std::string(depth, '(') + "1" + std::string(depth, ')'))) == "1");
+
+        std::string too_deep = std::string(100000, '(') + "1" + std::string(100000, ')');
+        for (const std::string& source : { too_deep, "f(" + too_deep + ")", std::string(100000, '[') + "1" }) {
+            W::Diagnostics diagnostics;
+            CHECK(parse_all(arena, source, diagnostics) == 0);
+            REQUIRE(diagnostics.size() == 1);
+            CHECK(diagnostics.all()[0].type == W::ExceptionType::ParserNestingTooDeep);
+        }
+    }
+    SECTION("lazy bodies") {
+        std::istringstream data(
+            "fn f(a int) int {\n    b := (a + 1)\n    g(b, ]\n}\n"
+            "fn h() { fn i() { 1 } }\n"
+        );
+        W::TokenBuffer tokens = W::Lexer("test.w", data).lex_all();
+        W::TokenStream token_stream(tokens);
+        W::Diagnostics diagnostics;
+        W::Parser parser(token_stream, arena, diagnostics, W::Parser::Options { .lazy_bodies = true });
+
+        auto f = static_cast<W::Ast::DeclareFunctionStatement*>(parser.next());
+        auto h = static_cast<W::Ast::DeclareFunctionStatement*>(parser.next());
+        REQUIRE(token_stream.peek().kind == W::TokenKind::Eof);
+        // the error of the body is only found once it is parsed
+        CHECK(diagnostics.empty());
+        CHECK(f->parameters.size() == 1);
+        CHECK(f->body.empty());
+        REQUIRE(f->lazy_body != nullptr);
+        CHECK(fmt::format("{}", f->location) == "test.w:1:1");
+
+        W::Parser::parse_body(*f, arena, diagnostics);
+        CHECK(f->lazy_body == nullptr);
+        REQUIRE(f->body.size() == 1);
+        CHECK(f->body[0]->get_type() == W::Ast::NodeType::DeclareVariableStatement);
+        REQUIRE(diagnostics.size() == 1);
+        CHECK(fmt::format("{}", diagnostics.all()[0].location) == "test.w:3:10");
+
+        // parsed once
+        W::Parser::parse_body(*f, arena, diagnostics);
+        CHECK(f->body.size() == 1);
+
+        W::Parser::parse_body(*h, arena, diagnostics);
+        REQUIRE(h->body.size() == 1);
+        auto i = static_cast<W::Ast::DeclareFunctionStatement*>(h->body[0]);
+        CHECK(i->lazy_body == nullptr);
+        CHECK(i->body.size() == 1);
+    }
+    SECTION("recovery") {
+        W::Diagnostics diagnostics;
+        std::size_t count = parse_all(arena,
+            "a := 1 +\n"
+            "fn f(a int) int {\n"
+            "    b := (1 + ]\n"
+            "    c := b * 2\n"
+            "    d := ) 3\n"
+            "}\n"
+            "const mut e := 0x\n"
+            "f(1, 2\n"
+            "g := 4\n",
+            diagnostics
+        );
+
+        // the function, `const mut e` and `g` are kept
+        CHECK(count == 3);
+        REQUIRE(diagnostics.size() == 6);
+        auto all = diagnostics.all();
+        CHECK(all[0].type == W::ExceptionType::ParserUnexpectedToken);
+        CHECK(fmt::format("{}", all[0].location) == "test.w:2:1");
+        CHECK(all[1].type == W::ExceptionType::ParserUnexpectedToken);
+        CHECK(fmt::format("{}", all[1].location) == "test.w:3:15");
+        CHECK(all[2].type == W::ExceptionType::ParserUnexpectedToken);
+        CHECK(fmt::format("{}", all[2].location) == "test.w:5:10");
+        CHECK(all[3].type == W::ExceptionType::ParserUnexpectedConstMutability);
+        CHECK(all[4].type == W::ExceptionType::LexerInvalidLiteral);
+        CHECK(all[5].type == W::ExceptionType::ParserExpectedToken);
+        CHECK(fmt::format("{}", all[5].location) == "test.w:9:1");
+    }
+}
@@ -0,0 +1,55 @@
+#include <sstream>
+#include <string>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <frontend/lexer.hpp>
+#include <frontend/parser.hpp>
+#include <frontend/pipelined_lexer.hpp>
+#include <frontend/token_buffer.hpp>
+#include <frontend/token_stream.hpp>
+
+TEST_CASE("pipelined_lexer") {
+    // enough tokens to go several times around the ring of batches
+    std::string source;
+    for (int i = 0; i < 20000; i++)
+        source += "a" + std::to_string(i) + " := (" + std::to_string(i) + " + b) * \"s\"\n";
+
+    std::istringstream input(source);
+    W::FileId file = W::SourceManager::global().add("test.w", W::SourceBuffer::load(input));
+    W::TokenBuffer expected = W::Lexer(file).lex_all();
+
+    SECTION("same tokens as the lexer") {
+        W::PipelinedLexer lexer(file);
+
+        for (std::size_t i = 0; i < expected.size(); i++) {
+            W::Token token = lexer.next();
+            REQUIRE(token.kind == expected.kinds()[i]);
+            REQUIRE(token.offset == expected.offsets()[i]);
+            REQUIRE(token.payload == expected.payloads()[i]);
+        }
+
+        // the Eof is repeated past the end
+        CHECK(lexer.next().kind == W::TokenKind::Eof);
+        CHECK(lexer.next().kind == W::TokenKind::Eof);
+    }
+    SECTION("destroyed before the end") {
+        // the lexer thread is blocked on the full ring, it must be stopped
+        W::PipelinedLexer lexer(file);
+        CHECK(lexer.next().kind == W::TokenKind::Ident);
+    }
+    SECTION("parser") {
+        W::PipelinedLexer lexer(file);
+        W::TokenStream token_stream(lexer);
+        W::utils::Arena arena;
+        W::Diagnostics diagnostics;
+        W::Parser parser(token_stream, arena, diagnostics);
+
+        std::size_t count = 0;
+        while (token_stream.peek().kind != W::TokenKind::Eof) {
+            parser.next();
+            count++;
+        }
+        CHECK(count == 20000);
+    }
+}
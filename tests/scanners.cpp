@@ -0,0 +1,130 @@
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <frontend/scanners.hpp>
+#include <utils/utf8.hpp>
+
+TEST_CASE("scanners") {
+    using W::Scanners::Isa;
+
+    // every run is placed at every offset of a buffer longer than two avx2
+    // vectors so the vector loops and the scalar tails are all exercised
+    std::string_view runs[] = {
+        " \t\n\v\f\r   \n\n\t  x",
+        "snake_case_Identifier0123456789_with_a_long_tail_zZ+",
+        "a line comment which is long enough to cross several vectors\n rest",
+        "nested comment text without any delimiter before this * and /",
+        "string body long enough to need a few vectors \\n then ` ' and \"",
+        "",
+        std::string_view("\0 after nul", 11),
+        // valid multibyte sequences across the vector boundaries, then the
+        // invalid ones: stray continuation, truncated, overlong, surrogate,
+        // over U+10FFFF and a lead byte at the end
+        "h\u00e9llo w\u00f6rld \u2713 \U0001F600 \u00e9\u00e9\u00e9\u00e9\u00e9\u00e9\u00e9\u00e9\u00e9\u00e9\u00e9\u00e9\u00e9\u00e9 end",
+        "valid text then a stray \x80 continuation",
+        "truncated \xe2\x82 sequence",
+        "overlong \xc0\xaf and \xe0\x80\xaf",
+        "surrogate \xed\xa0\x80 here",
+        "too large \xf4\x90\x80\x80 here",
+        "lead byte at the end \xf0\x9f\x98",
+    };
+
+    const W::Scanners::Table& scalar = W::Scanners::table(Isa::Scalar);
+
+    for (Isa isa : {Isa::Sse2, Isa::Avx2}) {
+        if (!W::Scanners::is_supported(isa))
+            continue;
+
+        const W::Scanners::Table& table = W::Scanners::table(isa);
+        for (std::string_view run : runs) {
+            for (std::size_t offset = 0; offset < 40; offset++) {
+                std::string data(offset, ' ');
+                data.append(run);
+                data.append(70 - offset, 'q');
+
+                for (std::size_t start = 0; start <= offset; start += 7) {
+                    const char* begin = data.data() + start;
+                    const char* end = data.data() + data.size();
+
+                    CHECK(scalar.skip_whitespace(begin, end) == table.skip_whitespace(begin, end));
+                    CHECK(scalar.skip_ident(begin, end) == table.skip_ident(begin, end));
+                    CHECK(scalar.find_line_end(begin, end) == table.find_line_end(begin, end));
+                    CHECK(scalar.find_comment_delimiter(begin, end) == table.find_comment_delimiter(begin, end));
+                    CHECK(scalar.find_string_delimiter(begin, end) == table.find_string_delimiter(begin, end));
+                    CHECK(scalar.validate_utf8(begin, end) == table.validate_utf8(begin, end));
+
+                    std::vector<uint32_t> expected_starts;
+                    std::vector<uint32_t> starts;
+                    scalar.collect_line_starts(begin, end, expected_starts);
+                    table.collect_line_starts(begin, end, starts);
+                    CHECK(expected_starts == starts);
+
+                    // a truncated range must never be read past its end
+                    const char* short_end = begin + (end - begin) / 3;
+                    CHECK(scalar.skip_ident(begin, short_end) == table.skip_ident(begin, short_end));
+                    CHECK(scalar.find_line_end(begin, short_end) == table.find_line_end(begin, short_end));
+                    CHECK(scalar.validate_utf8(begin, short_end) == table.validate_utf8(begin, short_end));
+                }
+            }
+        }
+    }
+
+    SECTION("empty source") {
+        // an empty file has no memory, every scan gets two null pointers
+        for (Isa isa : {Isa::Scalar, Isa::Sse2, Isa::Avx2}) {
+            if (!W::Scanners::is_supported(isa))
+                continue;
+
+            const W::Scanners::Table& table = W::Scanners::table(isa);
+            CHECK(table.skip_whitespace(nullptr, nullptr) == nullptr);
+            CHECK(table.skip_ident(nullptr, nullptr) == nullptr);
+            CHECK(table.find_line_end(nullptr, nullptr) == nullptr);
+            CHECK(table.find_comment_delimiter(nullptr, nullptr) == nullptr);
+            CHECK(table.find_string_delimiter(nullptr, nullptr) == nullptr);
+            CHECK(table.validate_utf8(nullptr, nullptr) == nullptr);
+
+            std::vector<uint32_t> starts;
+            table.collect_line_starts(nullptr, nullptr, starts);
+            CHECK(starts.empty());
+        }
+    }
+    SECTION("scalar") {
+        std::string_view data = "  \t\nfoo_1 bar// x\n*/ \"a\\\"";
+        const char* begin = data.data();
+        const char* end = data.data() + data.size();
+
+        CHECK(scalar.skip_whitespace(begin, end) == begin + 4);
+        CHECK(scalar.skip_ident(begin + 4, end) == begin + 9);
+        CHECK(scalar.find_line_end(begin + 4, end) == begin + 17);
+        CHECK(scalar.find_comment_delimiter(begin, end) == begin + 13);
+        CHECK(scalar.find_string_delimiter(begin, end) == begin + 21);
+        CHECK(scalar.find_string_delimiter(begin + 22, end) == begin + 23);
+
+        std::vector<uint32_t> starts;
+        scalar.collect_line_starts(begin, end, starts);
+        CHECK(starts == std::vector<uint32_t> { 4, 18 });
+    }
+    SECTION("utf-8") {
+        std::string_view data = "a\u00e9\u20ac\U0001F600\xc3";
+        const char* begin = data.data();
+
+        CHECK(scalar.validate_utf8(begin, begin + data.size()) == begin + data.size() - 1);
+        CHECK(scalar.validate_utf8(begin, begin + data.size() - 1) == begin + data.size() - 1);
+
+        char32_t code_point;
+        CHECK(W::utils::decode_utf8(data.substr(0), code_point) == 1);
+        CHECK(code_point == U'a');
+        CHECK(W::utils::decode_utf8(data.substr(1), code_point) == 2);
+        CHECK(code_point == U'\u00e9');
+        CHECK(W::utils::decode_utf8(data.substr(3), code_point) == 3);
+        CHECK(code_point == U'\u20ac');
+        CHECK(W::utils::decode_utf8(data.substr(6), code_point) == 4);
+        CHECK(code_point == U'\U0001F600');
+        CHECK(W::utils::decode_utf8(data.substr(10), code_point) == 0);
+        CHECK(W::utils::decode_utf8("\xed\xa0\x80", code_point) == 0);
+        CHECK(W::utils::decode_utf8("\xc1\xbf", code_point) == 0);
+    }
+}
@@ -0,0 +1,96 @@
+#include <sstream>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <frontend/lexer.hpp>
+#include <frontend/parser.hpp>
+#include <frontend/token_stream.hpp>
+#include <passes/pass.hpp>
+#include <passes/static_pass.hpp>
+#include <utils/arena.hpp>
+
+// every node in the order of the virtual visitor, parents first
+struct VirtualOrder : W::Passes::VisitorPass {
+    #define WLANG_AST(X, C) void visit(W::Ast::X##C& node) override { \
+        types.push_back(node.get_type()); \
+        handle_children(node); \
+    }
+    #include <frontend/ast/node_list.hpp>
+
+    std::vector<W::Ast::NodeType> types;
+};
+
+struct StaticOrder : W::Passes::StaticPass<StaticOrder> {
+    #define WLANG_AST(X, C) void visit(W::Ast::X##C& node) { \
+        types.push_back(node.get_type()); \
+        traverse(node); \
+    }
+    #include <frontend/ast/node_list.hpp>
+
+    std::vector<W::Ast::NodeType> types;
+};
+
+// only defines the visits it needs, the others are traversed
+struct CountCalls : W::Passes::StaticPass<CountCalls> {
+    void visit(W::Ast::CallExpression& expr) {
+        calls++;
+        traverse(expr);
+    }
+
+    void visit(W::Ast::IntLiteral& lit) {
+        sum += lit.value;
+    }
+
+    std::size_t calls = 0;
+    int64_t sum = 0;
+};
+
+struct CountExpressions : W::Passes::StaticPass<CountExpressions> {
+    void visit(W::Ast::Expression& expr) {
+        expressions++;
+        traverse(expr);
+    }
+
+    std::size_t expressions = 0;
+};
+
+TEST_CASE("static_pass") {
+    std::istringstream data(
+        "pub fn f(a int, mut b []int) [2]int { c := g(a, h(-b, 4)).x }\n"
+        "(1 + 2) * f(3.5)\n"
+        "const s := \"a\\tb\"\n"
+    );
+    W::Lexer lexer("test.w", data);
+    W::TokenStream token_stream(lexer);
+    W::utils::Arena arena;
+    W::Diagnostics diagnostics;
+    W::Parser parser(token_stream, arena, diagnostics);
+
+    std::vector<W::Ast::StatementPtr> statements;
+    while (token_stream.peek().kind != W::TokenKind::Eof)
+        statements.push_back(parser.next());
+    REQUIRE(diagnostics.empty());
+
+    SECTION("same order as the virtual visitor") {
+        VirtualOrder virtual_order;
+        virtual_order.handle_statement(statements);
+
+        StaticOrder static_order;
+        static_order.dispatch(std::span(statements));
+
+        CHECK(virtual_order.types.size() == 29);
+        CHECK(static_order.types == virtual_order.types);
+        CHECK(static_order.types.front() == W::Ast::NodeType::DeclareFunctionStatement);
+    }
+    SECTION("default traversal") {
+        CountCalls pass;
+        pass.dispatch(std::span(statements));
+        CHECK(pass.calls == 3);
+        CHECK(pass.sum == 2 + 4 + 1 + 2);
+
+        CountExpressions expressions;
+        expressions.dispatch(std::span(statements));
+        CHECK(expressions.expressions == 29 - 4);
+    }
+}
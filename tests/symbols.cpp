@@ -0,0 +1,48 @@
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <frontend/lexer.hpp>
+#include <symbols.hpp>
+
+TEST_CASE("symbols") {
+    SECTION("interning") {
+        W::SymbolTable table;
+
+        W::SymbolId foo = table.intern("foo");
+        W::SymbolId bar = table.intern("bar");
+
+        CHECK(foo != bar);
+        CHECK(foo == table.intern(std::string("foo")));
+        CHECK(table.name(foo) == "foo");
+        CHECK(table.name(bar) == "bar");
+        CHECK(table.name(table.intern("")) == "");
+
+        // enough names to grow every shard several times
+        std::vector<W::SymbolId> symbols;
+        for (int i = 0; i < 20000; i++)
+            symbols.push_back(table.intern(fmt::format("name_{}", i)));
+
+        for (int i = 0; i < 20000; i++) {
+            CHECK(table.name(symbols[i]) == fmt::format("name_{}", i));
+            CHECK(table.intern(fmt::format("name_{}", i)) == symbols[i]);
+        }
+        CHECK(table.intern("foo") == foo);
+    }
+
+    SECTION("lexer") {
+        std::istringstream data("value other value");
+        W::Lexer lexer("test.w", data);
+
+        W::Token first = lexer.next();
+        W::Token other = lexer.next();
+        W::Token second = lexer.next();
+
+        CHECK(first.symbol() == second.symbol());
+        CHECK(first.symbol() != other.symbol());
+        CHECK(W::SymbolTable::global().name(first.symbol()) == "value");
+        CHECK(fmt::format("{}", other.symbol()) == "other");
+    }
+}
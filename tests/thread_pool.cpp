@@ -0,0 +1,77 @@
+#include <atomic>
+#include <mutex>
+#include <stdexcept>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <utils/thread_pool.hpp>
+
+TEST_CASE("thread_pool") {
+    W::utils::ThreadPool pool(4);
+    REQUIRE(pool.size() == 4);
+
+    SECTION("tasks submitted by tasks") {
+        std::atomic<int> count = 0;
+        for (int i = 0; i < 100; i++) {
+            pool.submit([&] {
+                for (int j = 0; j < 100; j++)
+                    pool.submit([&] { count++; });
+                count++;
+            });
+        }
+
+        pool.wait();
+        CHECK(count == 100 * 101);
+    }
+    SECTION("outside tasks in order") {
+        W::utils::ThreadPool single(1);
+        std::mutex mutex;
+        std::vector<int> order;
+        for (int i = 0; i < 100; i++) {
+            single.submit([&, i] {
+                std::lock_guard lock(mutex);
+                order.push_back(i);
+            });
+        }
+
+        single.wait();
+        REQUIRE(order.size() == 100);
+        for (int i = 0; i < 100; i++)
+            CHECK(order[i] == i);
+    }
+    SECTION("exception") {
+        std::atomic<int> count = 0;
+        for (int i = 0; i < 100; i++) {
+            pool.submit([&, i] {
+                count++;
+                if (i == 50)
+                    throw std::runtime_error("task");
+            });
+        }
+
+        CHECK_THROWS_AS(pool.wait(), std::runtime_error);
+        CHECK(count == 100);
+
+        // the error is only thrown once
+        pool.submit([&] { count++; });
+        pool.wait();
+        CHECK(count == 101);
+    }
+    SECTION("run_all") {
+        std::atomic<int> count = 0;
+        pool.run_all(100, [&](std::size_t) { count++; });
+        CHECK(count == 100);
+
+        // called by tasks, the workers keep running tasks while they wait
+        for (int i = 0; i < 8; i++)
+            pool.submit([&] { pool.run_all(100, [&](std::size_t) { count++; }); });
+        pool.wait();
+        CHECK(count == 900);
+
+        CHECK_THROWS_AS(pool.run_all(10, [](std::size_t i) {
+            if (i == 5)
+                throw std::runtime_error("task");
+        }), std::runtime_error);
+    }
+}
@@ -1,11 +1,13 @@
 #include <variant>
 #include <utility>
 #include <sstream>
+#include <string>
 #include <vector>
 
 #include <catch2/catch_test_macros.hpp>
 
 #include <frontend/lexer.hpp>
+#include <frontend/token_buffer.hpp>
 #include <frontend/token_stream.hpp>
 #include <utils/types.hpp>
 
@@ -25,13 +27,13 @@ TEST_CASE("token_stream") {
             W::Token token = token_stream.next();
 
             CHECK(expected.first == token.kind);
-            CHECK(expected.second == token.raw);
+            CHECK(expected.second == token_stream.raw(token));
         }
 
         W::Token token = token_stream.next();
         CHECK(token.kind == W::TokenKind::Eof);
     }
-    SECTION("uncommit") {
+    SECTION("rewind") {
         std::istringstream data("a := 69");
         W::Lexer lexer("test.w", data);
         W::TokenStream token_stream(lexer);
@@ -41,53 +43,126 @@ TEST_CASE("token_stream") {
             {W::TokenKind::DeclAssign, ""},
             {W::TokenKind::Integer, "69"},
         };
-        
-        for (auto expected : expecteds) {
-            W::Token token = token_stream.next();
 
-            CHECK(expected.first == token.kind);
-            CHECK(expected.second == token.raw);
-        }
+        W::TokenStream::Checkpoint checkpoint = token_stream.checkpoint();
+        for (int i = 0; i < 2; i++) {
+            for (auto expected : expecteds) {
+                W::Token token = token_stream.next();
 
-        // reset the iteration
-        token_stream.uncommit();
-        
-        for (auto expected : expecteds) {
-            W::Token token = token_stream.next();
+                CHECK(expected.first == token.kind);
+                CHECK(expected.second == token_stream.raw(token));
+            }
 
-            CHECK(expected.first == token.kind);
-            CHECK(expected.second == token.raw);
+            // reset the iteration
+            checkpoint.rewind();
         }
-
-        W::Token token = token_stream.next();
-        CHECK(token.kind == W::TokenKind::Eof);
     }
-    SECTION("commit") {
-        std::istringstream data("a := 69");
+    SECTION("nested checkpoints") {
+        std::istringstream data("a := 69 + b");
         W::Lexer lexer("test.w", data);
         W::TokenStream token_stream(lexer);
 
-        std::pair<W::TokenKind, std::string> expecteds[] = {
-            {W::TokenKind::Ident, std::string("a")},
-            {W::TokenKind::DeclAssign, ""},
-        };
-        
-        for (auto expected : expecteds) {
-            W::Token token = token_stream.next();
+        W::TokenStream::Checkpoint outer = token_stream.checkpoint();
+        CHECK(token_stream.next().kind == W::TokenKind::Ident);
+        CHECK(token_stream.next().kind == W::TokenKind::DeclAssign);
+        {
+            W::TokenStream::Checkpoint inner = token_stream.checkpoint();
+            CHECK(token_stream.next().kind == W::TokenKind::Integer);
+            CHECK(token_stream.next().kind == W::TokenKind::Plus);
 
-            CHECK(expected.first == token.kind);
-            CHECK(expected.second == token.raw);
+            inner.rewind();
+            CHECK(token_stream.raw(token_stream.next()) == "69");
+
+            // the outer checkpoint still holds the tokens before the inner one
+            outer.rewind();
+            CHECK(token_stream.raw(token_stream.next()) == "a");
+        }
+
+        outer.rewind();
+        for (W::TokenKind kind : { W::TokenKind::Ident, W::TokenKind::DeclAssign, W::TokenKind::Integer, W::TokenKind::Plus, W::TokenKind::Ident })
+            CHECK(token_stream.next().kind == kind);
+        CHECK(token_stream.next().kind == W::TokenKind::Eof);
+        CHECK(token_stream.next().kind == W::TokenKind::Eof);
+    }
+    SECTION("bounded memory") {
+        std::string source;
+        for (int i = 0; i < 10000; i++)
+            source += "a" + std::to_string(i) + " := (" + std::to_string(i) + " + b) * c\n";
+
+        std::istringstream data(source);
+        W::Lexer lexer("test.w", data);
+        W::TokenStream token_stream(lexer, 16);
+
+        std::size_t count = 0;
+        while (token_stream.peek().kind != W::TokenKind::Eof) {
+            // a checkpoint per statement, as a backtracking parser would do
+            W::TokenStream::Checkpoint statement = token_stream.checkpoint();
+            for (int i = 0; i < 9; i++)
+                token_stream.next();
+
+            statement.rewind();
+            CHECK(token_stream.raw(token_stream.next()) == "a" + std::to_string(count));
+            for (int i = 1; i < 9; i++)
+                token_stream.next();
+            count++;
         }
-        token_stream.commit();
 
-        W::Token token1 = token_stream.next();
-        CHECK(W::TokenKind::Integer == token1.kind);
-        CHECK("69" == token1.raw);
+        CHECK(count == 10000);
+        CHECK(token_stream.capacity() == 16);
 
-        token_stream.uncommit();
+        // a checkpoint spanning more tokens than the ring makes it grow
+        std::istringstream long_data(source);
+        W::Lexer long_lexer("test.w", long_data);
+        W::TokenStream long_stream(long_lexer, 16);
+        W::TokenStream::Checkpoint start = long_stream.checkpoint();
+        for (int i = 0; i < 100; i++)
+            long_stream.next();
 
-        W::Token token2 = token_stream.next();
-        CHECK(W::TokenKind::Integer == token2.kind);
-        CHECK("69" == token2.raw);
+        CHECK(long_stream.capacity() == 128);
+        start.rewind();
+        CHECK(long_stream.raw(long_stream.next()) == "a0");
+    }
+    SECTION("token buffer") {
+        std::istringstream data("a := 69\nb := a");
+        W::Lexer lexer("test.w", data);
+        W::TokenBuffer tokens = lexer.lex_all();
+
+        W::TokenKind kinds[] = {
+            W::TokenKind::Ident,
+            W::TokenKind::DeclAssign,
+            W::TokenKind::Integer,
+            W::TokenKind::Ident,
+            W::TokenKind::DeclAssign,
+            W::TokenKind::Ident,
+            W::TokenKind::Eof,
+        };
+        REQUIRE(tokens.size() == std::size(kinds));
+        for (size_t i = 0; i < tokens.size(); i++)
+            CHECK(tokens.kinds()[i] == kinds[i]);
+
+        W::TokenStream token_stream(tokens);
+
+        CHECK(token_stream.peek(2).kind == W::TokenKind::Integer);
+        CHECK(token_stream.raw(token_stream.peek(2)) == "69");
+        // the Eof is repeated past the end
+        CHECK(token_stream.peek(100).kind == W::TokenKind::Eof);
+
+        W::Token a = token_stream.next();
+        CHECK(token_stream.raw(a) == "a");
+        token_stream.next();
+
+        W::TokenStream::Checkpoint checkpoint = token_stream.checkpoint();
+        CHECK(token_stream.next().kind == W::TokenKind::Integer);
+        checkpoint.rewind();
+        CHECK(token_stream.next().kind == W::TokenKind::Integer);
+
+        for (size_t i = 3; i < tokens.size(); i++)
+            CHECK(token_stream.next().kind == kinds[i]);
+        CHECK(token_stream.next().kind == W::TokenKind::Eof);
+
+        W::Token b = tokens[3];
+        CHECK(a.symbol() == tokens[5].symbol());
+        CHECK(a.symbol() != b.symbol());
+        CHECK(fmt::format("{}", token_stream.location(b)) == "test.w:2:1");
     }
 }
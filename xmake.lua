@@ -33,3 +33,14 @@ target("tests")
     add_files("src/**.cpp")
     add_files("tests/**.cpp")
     remove_files("src/main.cpp")
+
+target("benchmarks")
+    set_kind("binary")
+    set_default(false)
+    add_packages("fmt")
+    add_packages("frozen")
+    add_packages("catch2")
+    add_packages("cpptrace")
+    add_files("src/**.cpp")
+    add_files("benchmarks/**.cpp")
+    remove_files("src/main.cpp")